@@ -0,0 +1,856 @@
+#include <corgi/binary/binary.h>
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Every allocation of the program goes through these, so we can tell how
+// many times a benchmark hit the heap
+
+static std::size_t allocation_count = 0;
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+    if(void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+using corgi::binary::dynamic_bitset;
+
+/**
+ * @brief   Sizes every operation is measured at, powers of 8 from 64 bits
+ *          to 1G bits
+ */
+constexpr std::array<std::size_t, 9> sizes {
+    64, 512, 4096, 32768, 262144, 2097152, 16777216, 134217728, 1073741824};
+
+/**
+ * @brief   Number of random positions used by the single bit operations
+ */
+constexpr std::size_t position_count = 4096;
+
+struct options
+{
+    std::size_t max_bits {sizes.back()};
+    double      min_time_ms {50.0};
+    std::string filter;
+    std::string json_path;
+
+    // Where the results are printed as a table, stderr when the JSON goes
+    // to stdout
+    std::FILE* table {stdout};
+};
+
+struct measurement
+{
+    std::string operation;
+    std::string container;
+    std::size_t bits;
+    std::size_t iterations;
+    double      ns_per_op;
+
+    // 0 for the operations touching a single bit
+    double bytes_per_second;
+};
+
+struct allocation_result
+{
+    std::string container;
+    std::size_t bits;
+    double      allocations_per_object;
+    double      ns_per_object;
+};
+
+// Results of the operations go there so the compiler can't drop them
+volatile std::size_t sink = 0;
+
+/**
+ * @brief   Runs the operations and stores their timings
+ */
+class runner
+{
+public:
+    explicit runner(const options& opts)
+        : options_(opts)
+    {
+    }
+
+    /**
+     * @brief   Measures @p operation, called with the iteration index
+     *
+     * The number of iterations grows until they take at least
+     * options::min_time_ms.
+     *
+     * @param bytes Bytes read or written by a call, 0 for the operations
+     *              touching a single bit
+     */
+    template<class Operation>
+    void run(std::string_view operation,
+             std::string_view container,
+             std::size_t      bits,
+             std::size_t      bytes,
+             Operation&&      op)
+    {
+        if(!options_.filter.empty() &&
+           operation.find(options_.filter) == std::string_view::npos)
+            return;
+
+        const auto min_time = options_.min_time_ms * 1e6;
+
+        // Warms up the caches and the branch predictors
+        sink = sink + op(std::size_t {0});
+
+        std::size_t iterations = 1;
+        double      elapsed    = 0.0;
+        while(true)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            std::size_t checksum = 0;
+            for(std::size_t i = 0; i < iterations; i++)
+            {
+                checksum += op(i);
+
+                // Keeps the calls from being merged or hoisted out of the
+                // loop when their operands don't change
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            }
+
+            const auto end = std::chrono::steady_clock::now();
+            sink           = sink + checksum;
+
+            elapsed =
+                std::chrono::duration<double, std::nano>(end - start).count();
+            if(elapsed >= min_time)
+                break;
+
+            // Aims a bit past min_time, growing 10 times at most
+            const auto scale =
+                elapsed <= 0.0 ? 10.0
+                               : std::min(10.0, 1.2 * min_time / elapsed);
+            iterations = std::max(
+                iterations + 1,
+                static_cast<std::size_t>(static_cast<double>(iterations) *
+                                         scale));
+        }
+
+        const auto ns_per_op = elapsed / static_cast<double>(iterations);
+        const auto throughput =
+            bytes == 0 ? 0.0 : static_cast<double>(bytes) / ns_per_op * 1e9;
+
+        results_.push_back({std::string(operation), std::string(container),
+                            bits, iterations, ns_per_op, throughput});
+
+        std::fprintf(options_.table, "%-16s %-18s %12zu %14.2f %10.2f\n",
+                     results_.back().operation.c_str(),
+                     results_.back().container.c_str(), bits, ns_per_op,
+                     throughput / 1e9);
+        std::fflush(options_.table);
+    }
+
+    const std::vector<measurement>& results() const noexcept
+    {
+        return results_;
+    }
+
+private:
+    const options&           options_;
+    std::vector<measurement> results_;
+};
+
+/**
+ * @brief   Returns @p count positions in [0, @p bits) from a fixed seed
+ */
+std::vector<std::size_t> random_positions(std::size_t bits, std::size_t count)
+{
+    // splitmix64
+    std::uint64_t            state = 0x9E3779B97F4A7C15;
+    std::vector<std::size_t> positions(count);
+    for(auto& pos : positions)
+    {
+        state += 0x9E3779B97F4A7C15;
+        auto z = state;
+        z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z      = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        pos    = static_cast<std::size_t>((z ^ (z >> 31)) % bits);
+    }
+    return positions;
+}
+
+void dynamic_bitset_benchmarks(runner& bench, std::size_t n)
+{
+    const auto name      = "dynamic_bitset";
+    const auto bytes     = n / 8;
+    const auto positions = random_positions(n, position_count);
+    const auto at        = [&](std::size_t i)
+    { return positions[i % position_count]; };
+
+    dynamic_bitset a(n, false);
+    dynamic_bitset b(n, false);
+    for(std::size_t i = 0; i < n; i += 3)
+        a.set(i);
+    for(std::size_t i = 0; i < n; i += 5)
+        b.set(i);
+
+    const dynamic_bitset ones(n, true);
+    const dynamic_bitset zeros(n, false);
+    const dynamic_bitset copy = a;
+
+    // Never modified, so equal always goes through every block whatever ran
+    // before it
+    const dynamic_bitset same = a;
+
+    bench.run("construct", name, n, bytes,
+              [&](std::size_t)
+              {
+                  dynamic_bitset bits(n, false);
+                  return bits.size();
+              });
+    bench.run("test", name, n, 0,
+              [&](std::size_t i) { return std::size_t {a.test(at(i))}; });
+    bench.run("set", name, n, 0,
+              [&](std::size_t i)
+              {
+                  a.set(at(i), (i & 1) != 0);
+                  return std::size_t {0};
+              });
+    bench.run("set_all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  b.set();
+                  return std::size_t {0};
+              });
+    bench.run("reset_all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  b.reset();
+                  return std::size_t {0};
+              });
+    bench.run("flip_all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  b.flip();
+                  return std::size_t {0};
+              });
+    bench.run("count", name, n, bytes,
+              [&](std::size_t) { return a.count(); });
+    bench.run("all", name, n, bytes,
+              [&](std::size_t) { return std::size_t {ones.all()}; });
+    bench.run("any", name, n, bytes,
+              [&](std::size_t) { return std::size_t {zeros.any()}; });
+    bench.run("none", name, n, bytes,
+              [&](std::size_t) { return std::size_t {zeros.none()}; });
+    bench.run("equal", name, n, 2 * bytes,
+              [&](std::size_t) { return std::size_t {copy == same}; });
+    bench.run("and", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  b &= copy;
+                  return std::size_t {0};
+              });
+    bench.run("or", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  b |= copy;
+                  return std::size_t {0};
+              });
+    bench.run("xor", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  b ^= copy;
+                  return std::size_t {0};
+              });
+    bench.run("minus", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  b -= copy;
+                  return std::size_t {0};
+              });
+
+    // The operators returning a new bitset read 2 operands and write the
+    // result, allocated on each call
+    bench.run("and_new", name, n, 3 * bytes,
+              [&](std::size_t) { return (copy & same).size(); });
+    bench.run("or_new", name, n, 3 * bytes,
+              [&](std::size_t) { return (copy | same).size(); });
+    bench.run("xor_new", name, n, 3 * bytes,
+              [&](std::size_t) { return (copy ^ same).size(); });
+    bench.run("minus_new", name, n, 3 * bytes,
+              [&](std::size_t) { return (copy - same).size(); });
+    bench.run("not_new", name, n, 2 * bytes,
+              [&](std::size_t) { return (~copy).size(); });
+    bench.run("copy", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  dynamic_bitset bits(copy);
+                  return bits.size();
+              });
+    bench.run("count_range", name, n, bytes / 2,
+              [&](std::size_t) { return copy.count(n / 4, n / 4 + n / 2); });
+
+    // Visits the set bits of a bitset with one bit out of 256 set
+    dynamic_bitset sparse(n, false);
+    for(std::size_t i = 0; i < n; i += 256)
+        sparse.set(i);
+    auto cursor = dynamic_bitset::npos;
+    bench.run("find_next", name, n, 0,
+              [&](std::size_t)
+              {
+                  cursor = sparse.find_next(cursor);
+                  return cursor;
+              });
+    cursor = dynamic_bitset::npos;
+    bench.run("find_prev", name, n, 0,
+              [&](std::size_t)
+              {
+                  cursor = cursor == dynamic_bitset::npos
+                               ? sparse.find_last()
+                               : sparse.find_prev(cursor);
+                  return cursor;
+              });
+
+    // A single bit in the middle, both searches go through half the blocks
+    dynamic_bitset lone(n, false);
+    lone.set(std::size_t {n / 2});
+    bench.run("find_first", name, n, bytes / 2,
+              [&](std::size_t) { return lone.find_first(); });
+    bench.run("find_last", name, n, bytes / 2,
+              [&](std::size_t) { return lone.find_last(); });
+
+    // The size is restored after each call so the calls are comparable
+    bench.run("insert", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  a.insert(n / 2, true);
+                  a.pop_back();
+                  return a.size();
+              });
+    bench.run("erase", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  a.erase(n / 2);
+                  a.push_back(false);
+                  return a.size();
+              });
+    bench.run("slice", name, n, bytes / 2,
+              [&](std::size_t)
+              { return a.slice(n / 4, n / 4 + n / 2 - 1).size(); });
+    bench.run("push_back", name, n, 0,
+              [&](std::size_t i)
+              {
+                  a.push_back((i & 1) != 0);
+                  a.pop_back();
+                  return a.size();
+              });
+    bench.run("resize", name, n, 0,
+              [&](std::size_t)
+              {
+                  a.resize(n + 64, false);
+                  a.resize(n);
+                  return a.size();
+              });
+    bench.run("set_range", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  b.set_range(n / 4, n / 4 + n / 2);
+                  return std::size_t {0};
+              });
+    bench.run("reset_range", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  b.reset_range(n / 4, n / 4 + n / 2);
+                  return std::size_t {0};
+              });
+
+    // Fields of 40 bits at random positions
+    bench.run("bits_to_ullong", name, n, 0,
+              [&](std::size_t i)
+              {
+                  return static_cast<std::size_t>(
+                      corgi::binary::bits_to_ullong(at(i) % (n - 40), 40,
+                                                    a.data(), a.byte_size()));
+              });
+    bench.run("to_ullong", name, n, 0,
+              [&](std::size_t i)
+              {
+                  return static_cast<std::size_t>(
+                      a.to_ullong(at(i) % (n - 40), 40));
+              });
+
+    // Allocation map with a single free run, at the end
+    dynamic_bitset pages(n, true);
+    pages.reset_range(n - 32, n);
+    bench.run("find_first_run", name, n, bytes,
+              [&](std::size_t) { return pages.find_first_run(false, 16); });
+    bench.run("claim_run", name, n, bytes,
+              [&](std::size_t)
+              {
+                  const auto page = pages.claim_run(16);
+                  pages.reset_range(page, page + 16);
+                  return page;
+              });
+
+    // Text conversions, with one character per bit
+    const auto text = corgi::binary::to_string(copy);
+    bench.run("to_string", name, n, n + bytes,
+              [&](std::size_t)
+              { return corgi::binary::to_string(copy).size(); });
+    bench.run("from_string", name, n, n + bytes,
+              [&](std::size_t)
+              { return corgi::binary::from_string(text).size(); });
+}
+
+void vector_bool_benchmarks(runner& bench, std::size_t n)
+{
+    const auto name      = "std::vector<bool>";
+    const auto bytes     = n / 8;
+    const auto positions = random_positions(n, position_count);
+    const auto at        = [&](std::size_t i)
+    { return positions[i % position_count]; };
+
+    std::vector<bool> a(n, false);
+    std::vector<bool> b(n, false);
+    for(std::size_t i = 0; i < n; i += 3)
+        a[i] = true;
+    for(std::size_t i = 0; i < n; i += 5)
+        b[i] = true;
+
+    const std::vector<bool> ones(n, true);
+    const std::vector<bool> zeros(n, false);
+    const std::vector<bool> copy = a;
+
+    // Never modified, so equal always goes through every block whatever ran
+    // before it
+    const std::vector<bool> same = a;
+
+    bench.run("construct", name, n, bytes,
+              [&](std::size_t)
+              {
+                  std::vector<bool> bits(n, false);
+                  return bits.size();
+              });
+    bench.run("test", name, n, 0,
+              [&](std::size_t i) { return std::size_t {a[at(i)]}; });
+    bench.run("set", name, n, 0,
+              [&](std::size_t i)
+              {
+                  a[at(i)] = (i & 1) != 0;
+                  return std::size_t {a[at(i)]};
+              });
+    bench.run("set_all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  std::fill(b.begin(), b.end(), true);
+                  return std::size_t {b[0]};
+              });
+    bench.run("reset_all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  std::fill(b.begin(), b.end(), false);
+                  return std::size_t {b[0]};
+              });
+    bench.run("flip_all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  b.flip();
+                  return std::size_t {b[0]};
+              });
+    bench.run("count", name, n, bytes,
+              [&](std::size_t)
+              {
+                  return static_cast<std::size_t>(
+                      std::count(a.begin(), a.end(), true));
+              });
+    bench.run("all", name, n, bytes,
+              [&](std::size_t)
+              {
+                  return std::size_t {std::find(ones.begin(), ones.end(),
+                                                false) == ones.end()};
+              });
+    bench.run("any", name, n, bytes,
+              [&](std::size_t)
+              {
+                  return std::size_t {std::find(zeros.begin(), zeros.end(),
+                                                true) != zeros.end()};
+              });
+    bench.run("none", name, n, bytes,
+              [&](std::size_t)
+              {
+                  return std::size_t {std::find(zeros.begin(), zeros.end(),
+                                                true) == zeros.end()};
+              });
+    bench.run("equal", name, n, 2 * bytes,
+              [&](std::size_t) { return std::size_t {copy == same}; });
+    bench.run("and", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  std::transform(b.begin(), b.end(), copy.begin(), b.begin(),
+                                 std::bit_and<bool>());
+                  return std::size_t {b[0]};
+              });
+    bench.run("or", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  std::transform(b.begin(), b.end(), copy.begin(), b.begin(),
+                                 std::bit_or<bool>());
+                  return std::size_t {b[0]};
+              });
+    bench.run("xor", name, n, 2 * bytes,
+              [&](std::size_t)
+              {
+                  std::transform(b.begin(), b.end(), copy.begin(), b.begin(),
+                                 std::bit_xor<bool>());
+                  return std::size_t {b[0]};
+              });
+
+    std::vector<bool> sparse(n, false);
+    for(std::size_t i = 0; i < n; i += 256)
+        sparse[i] = true;
+    auto cursor = sparse.end();
+    bench.run("find_next", name, n, 0,
+              [&](std::size_t)
+              {
+                  cursor = std::find(
+                      cursor == sparse.end() ? sparse.begin() : cursor + 1,
+                      sparse.end(), true);
+                  return static_cast<std::size_t>(cursor - sparse.begin());
+              });
+
+    bench.run("insert", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  a.insert(a.begin() + static_cast<std::ptrdiff_t>(n / 2),
+                           true);
+                  a.pop_back();
+                  return a.size();
+              });
+    bench.run("erase", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  a.erase(a.begin() + static_cast<std::ptrdiff_t>(n / 2));
+                  a.push_back(false);
+                  return a.size();
+              });
+    bench.run("slice", name, n, bytes / 2,
+              [&](std::size_t)
+              {
+                  const auto first =
+                      a.begin() + static_cast<std::ptrdiff_t>(n / 4);
+                  return std::vector<bool>(
+                             first, first + static_cast<std::ptrdiff_t>(n / 2))
+                      .size();
+              });
+
+    std::vector<bool> pages(n, true);
+    std::fill(pages.end() - 32, pages.end(), false);
+    bench.run("find_first_run", name, n, bytes,
+              [&](std::size_t)
+              {
+                  return static_cast<std::size_t>(
+                      std::search_n(pages.begin(), pages.end(), 16, false) -
+                      pages.begin());
+              });
+}
+
+/**
+ * @brief   std::bitset has no construction from blocks, so the operands are
+ *          all 0 or all 1
+ */
+template<std::size_t N>
+void bitset_benchmarks(runner& bench)
+{
+    const auto name      = "std::bitset";
+    const auto bytes     = N / 8;
+    const auto positions = random_positions(N, position_count);
+    const auto at        = [&](std::size_t i)
+    { return positions[i % position_count]; };
+
+    // Too large for the stack past a few Mbits
+    const auto a     = std::make_unique<std::bitset<N>>();
+    const auto b     = std::make_unique<std::bitset<N>>();
+    const auto ones  = std::make_unique<std::bitset<N>>();
+    const auto zeros = std::make_unique<std::bitset<N>>();
+    ones->set();
+    const auto same = std::make_unique<std::bitset<N>>(*ones);
+
+    bench.run("test", name, N, 0,
+              [&](std::size_t i) { return std::size_t {a->test(at(i))}; });
+    bench.run("set", name, N, 0,
+              [&](std::size_t i)
+              {
+                  a->set(at(i), (i & 1) != 0);
+                  return std::size_t {(*a)[at(i)]};
+              });
+    bench.run("set_all", name, N, bytes,
+              [&](std::size_t)
+              {
+                  b->set();
+                  return std::size_t {(*b)[0]};
+              });
+    bench.run("reset_all", name, N, bytes,
+              [&](std::size_t)
+              {
+                  b->reset();
+                  return std::size_t {(*b)[0]};
+              });
+    bench.run("flip_all", name, N, bytes,
+              [&](std::size_t)
+              {
+                  b->flip();
+                  return std::size_t {(*b)[0]};
+              });
+    bench.run("count", name, N, bytes,
+              [&](std::size_t) { return a->count(); });
+    bench.run("all", name, N, bytes,
+              [&](std::size_t) { return std::size_t {ones->all()}; });
+    bench.run("any", name, N, bytes,
+              [&](std::size_t) { return std::size_t {zeros->any()}; });
+    bench.run("none", name, N, bytes,
+              [&](std::size_t) { return std::size_t {zeros->none()}; });
+    bench.run("equal", name, N, 2 * bytes,
+              [&](std::size_t) { return std::size_t {*ones == *same}; });
+    bench.run("and", name, N, 2 * bytes,
+              [&](std::size_t)
+              {
+                  *b &= *ones;
+                  return std::size_t {(*b)[0]};
+              });
+    bench.run("or", name, N, 2 * bytes,
+              [&](std::size_t)
+              {
+                  *b |= *zeros;
+                  return std::size_t {(*b)[0]};
+              });
+    bench.run("xor", name, N, 2 * bytes,
+              [&](std::size_t)
+              {
+                  *b ^= *ones;
+                  return std::size_t {(*b)[0]};
+              });
+}
+
+template<std::size_t... I>
+void bitset_benchmarks(runner&            bench,
+                       std::size_t        max_bits,
+                       std::index_sequence<I...>)
+{
+    ((sizes[I] <= max_bits ? bitset_benchmarks<sizes[I]>(bench) : void()),
+     ...);
+}
+
+/**
+ * @brief   Creates @p count containers of @p bits bits with @p make, and
+ *          reports the allocations and the time it took
+ */
+template<class Make>
+allocation_result measure_allocations(std::string_view container,
+                                      std::size_t      count,
+                                      std::size_t      bits,
+                                      Make             make)
+{
+    const auto allocations_before = allocation_count;
+    const auto start              = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0;
+    for(std::size_t i = 0; i < count; i++)
+        checksum += make(bits, i);
+
+    const auto end = std::chrono::steady_clock::now();
+    sink           = sink + checksum;
+
+    return {std::string(container), bits,
+            static_cast<double>(allocation_count - allocations_before) /
+                static_cast<double>(count),
+            std::chrono::duration<double, std::nano>(end - start).count() /
+                static_cast<double>(count)};
+}
+
+std::vector<allocation_result> allocation_benchmark(std::FILE* table)
+{
+    constexpr std::size_t count = 1000000;
+
+    std::fprintf(table, "%-20s %8s %14s %10s\n", "container", "bits",
+                 "allocations", "ns/object");
+
+    std::vector<allocation_result> results;
+    for(const std::size_t bits : {16, 64, 128, 129, 512})
+    {
+        results.push_back(
+            measure_allocations("dynamic_bitset", count, bits,
+                                [](std::size_t size, std::size_t i)
+                                {
+                                    dynamic_bitset bs(size);
+                                    bs.set(i % size);
+                                    return bs.count();
+                                }));
+
+        results.push_back(measure_allocations(
+            "std::vector<bool>", count, bits,
+            [](std::size_t size, std::size_t i)
+            {
+                std::vector<bool> v(size);
+                v[i % size] = true;
+                return static_cast<std::size_t>(v[0]);
+            }));
+    }
+
+    for(const auto& result : results)
+        std::fprintf(table, "%-20s %8zu %14.2f %10.1f\n",
+                     result.container.c_str(), result.bits,
+                     result.allocations_per_object, result.ns_per_object);
+    return results;
+}
+
+/**
+ * @brief   Writes the results as JSON to @p path, "-" being stdout
+ */
+bool write_json(const std::string&                    path,
+                const options&                        opts,
+                const std::vector<measurement>&       results,
+                const std::vector<allocation_result>& allocations)
+{
+    std::FILE* file = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+    if(file == nullptr)
+    {
+        std::fprintf(stderr, "Can't open %s\n", path.c_str());
+        return false;
+    }
+
+    std::fprintf(file, "{\n  \"benchmark\": \"corgi-binary-bench\",\n");
+    std::fprintf(file, "  \"min_time_ms\": %g,\n", opts.min_time_ms);
+
+    std::fprintf(file, "  \"results\": [");
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        const auto& r = results[i];
+        std::fprintf(file,
+                     "%s\n    {\"operation\": \"%s\", \"container\": \"%s\", "
+                     "\"bits\": %zu, \"iterations\": %zu, "
+                     "\"ns_per_op\": %.3f, \"bytes_per_second\": ",
+                     i == 0 ? "" : ",", r.operation.c_str(),
+                     r.container.c_str(), r.bits, r.iterations, r.ns_per_op);
+        if(r.bytes_per_second == 0.0)
+            std::fprintf(file, "null}");
+        else
+            std::fprintf(file, "%.0f}", r.bytes_per_second);
+    }
+    std::fprintf(file, "\n  ],\n");
+
+    std::fprintf(file, "  \"allocations\": [");
+    for(std::size_t i = 0; i < allocations.size(); i++)
+    {
+        const auto& a = allocations[i];
+        std::fprintf(file,
+                     "%s\n    {\"container\": \"%s\", \"bits\": %zu, "
+                     "\"allocations_per_object\": %.3f, "
+                     "\"ns_per_object\": %.3f}",
+                     i == 0 ? "" : ",", a.container.c_str(), a.bits,
+                     a.allocations_per_object, a.ns_per_object);
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+
+    if(file != stdout)
+        std::fclose(file);
+    return true;
+}
+
+void print_usage()
+{
+    std::puts(
+        "usage: corgi-binary-bench [--json FILE] [--max-bits N] "
+        "[--min-time MS] [--filter OPERATION]\n"
+        "\n"
+        "  --json FILE       Writes the results as JSON to FILE, - for stdout\n"
+        "  --max-bits N      Skips the sizes larger than N bits (1073741824)\n"
+        "  --min-time MS     Minimum time spent measuring an operation (50)\n"
+        "  --filter NAME     Only runs the operations whose name contains\n"
+        "                    NAME");
+}
+}    // namespace
+
+int main(int argc, char** argv)
+{
+    options opts;
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string_view arg   = argv[i];
+        const char*            value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if(arg == "--help" || arg == "-h")
+        {
+            print_usage();
+            return 0;
+        }
+
+        if(value == nullptr)
+        {
+            print_usage();
+            return 1;
+        }
+
+        if(arg == "--json")
+            opts.json_path = value;
+        else if(arg == "--max-bits")
+            opts.max_bits = std::strtoull(value, nullptr, 10);
+        else if(arg == "--min-time")
+            opts.min_time_ms = std::strtod(value, nullptr);
+        else if(arg == "--filter")
+            opts.filter = value;
+        else
+        {
+            print_usage();
+            return 1;
+        }
+        i++;
+    }
+
+    if(opts.json_path == "-")
+        opts.table = stderr;
+
+    const auto allocations = allocation_benchmark(opts.table);
+
+    std::fprintf(opts.table, "\n%-16s %-18s %12s %14s %10s\n", "operation",
+                 "container", "bits", "ns/op", "GB/s");
+
+    runner bench(opts);
+    for(const auto n : sizes)
+    {
+        if(n > opts.max_bits)
+            break;
+        dynamic_bitset_benchmarks(bench, n);
+        vector_bool_benchmarks(bench, n);
+    }
+    bitset_benchmarks(bench, opts.max_bits,
+                      std::make_index_sequence<sizes.size()>());
+
+    if(!opts.json_path.empty() &&
+       !write_json(opts.json_path, opts, bench.results(), allocations))
+        return 1;
+    return 0;
+}
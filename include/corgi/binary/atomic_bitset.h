@@ -0,0 +1,249 @@
+#pragma once
+
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Fixed size bitset whose bits can be read and modified by several
+ *          threads at once, without locks
+ *
+ * Bits are packed inside std::atomic<std::uint64_t> words, with the layout of
+ * dynamic_bitset. Every single bit operation is one atomic instruction on the
+ * word holding the bit. test_and_set() first checks the bit with a plain
+ * load, so marking a bit that is already set doesn't take the cache line
+ * away from the other threads.
+ *
+ * The memory order of each operation can be given, acq_rel being the
+ * default for the read-modify-write operations. relaxed is enough when the
+ * bitset is only read once the threads are joined.
+ *
+ * Operations touching the whole bitset (count(), merge(), to_bitset(),
+ * clear()) are atomic word by word only.
+ *
+ * @code
+ * atomic_bitset visited(graph.size());
+ * // In every worker thread
+ * if(!visited.test_and_set(node))
+ *     explore(node);
+ * @endcode
+ */
+class atomic_bitset
+{
+public:
+    using word_type = std::atomic<std::uint64_t>;
+
+    /**
+     * @brief   Constructs an empty bitset
+     */
+    atomic_bitset() noexcept = default;
+
+    /**
+     * @brief   Constructs a bitset of @p size bits set to 0
+     */
+    explicit atomic_bitset(std::size_t size);
+
+    /**
+     * @brief   Constructs a bitset holding a copy of @p bits
+     */
+    template<class Allocator>
+    explicit atomic_bitset(
+        const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+        : atomic_bitset(bits.size())
+    {
+        merge(bits, std::memory_order_relaxed);
+    }
+
+    atomic_bitset(atomic_bitset&& other) noexcept;
+    atomic_bitset& operator=(atomic_bitset&& other) noexcept;
+
+    /**
+     * @brief   Returns the number of bits of the bitset
+     */
+    std::size_t size() const noexcept { return size_; }
+
+    /**
+     * @brief   Returns the number of words storing the bits
+     */
+    std::size_t block_size() const noexcept
+    {
+        return detail::block_count<std::uint64_t>(size_);
+    }
+
+    /**
+     * @brief   Returns the value of the bit located at @p pos
+     *
+     * @param order Memory order of the load. A release part is ignored
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    bool test(std::size_t   pos,
+              std::memory_order order = std::memory_order_acquire) const
+    {
+        return (word(pos).load(load_order(order)) & mask(pos)) != 0;
+    }
+
+    /**
+     * @brief   Sets the bit located at @p pos
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    void set(std::size_t       pos,
+             std::memory_order order = std::memory_order_acq_rel)
+    {
+        test_and_set(pos, order);
+    }
+
+    /**
+     * @brief   Sets the bit located at @p pos and returns its previous value
+     *
+     * When several threads set the same bit, exactly one of them gets false.
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    bool test_and_set(std::size_t       pos,
+                      std::memory_order order = std::memory_order_acq_rel)
+    {
+        auto&      w = word(pos);
+        const auto m = mask(pos);
+
+        // Already set : no need to write, and so to own the cache line
+        if((w.load(load_order(order)) & m) != 0)
+            return true;
+
+        return (w.fetch_or(m, order) & m) != 0;
+    }
+
+    /**
+     * @brief   Resets the bit located at @p pos
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    void reset(std::size_t       pos,
+               std::memory_order order = std::memory_order_acq_rel)
+    {
+        fetch_reset(pos, order);
+    }
+
+    /**
+     * @brief   Resets the bit located at @p pos and returns its previous
+     *          value
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    bool fetch_reset(std::size_t       pos,
+                     std::memory_order order = std::memory_order_acq_rel)
+    {
+        const auto m = mask(pos);
+        return (word(pos).fetch_and(~m, order) & m) != 0;
+    }
+
+    /**
+     * @brief   Flips the bit located at @p pos and returns its previous value
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    bool fetch_flip(std::size_t       pos,
+                    std::memory_order order = std::memory_order_acq_rel)
+    {
+        const auto m = mask(pos);
+        return (word(pos).fetch_xor(m, order) & m) != 0;
+    }
+
+    /**
+     * @brief   Sets the bits that are set in @p other, a word at a time
+     *
+     * Words of @p other that are 0, or whose bits are already set, are
+     * skipped without writing.
+     *
+     * @throws std::invalid_argument Thrown if @p other doesn't have the same
+     * size
+     */
+    template<class Allocator>
+    void merge(const basic_dynamic_bitset<std::uint64_t, Allocator>& other,
+               std::memory_order order = std::memory_order_acq_rel)
+    {
+        check_same_size(other.size());
+        merge(other.blocks(), order);
+    }
+
+    /**
+     * @brief   Sets the bits that are set in @p other, see merge()
+     *
+     * @throws std::invalid_argument Thrown if @p other doesn't have the same
+     * size
+     */
+    void merge(const atomic_bitset& other,
+               std::memory_order    order = std::memory_order_acq_rel);
+
+    /**
+     * @brief   Returns the number of bits that are set
+     */
+    std::size_t
+    count(std::memory_order order = std::memory_order_acquire) const noexcept;
+
+    /**
+     * @brief   Resets every bit
+     */
+    void clear(std::memory_order order = std::memory_order_release) noexcept;
+
+    /**
+     * @brief   Returns a copy of the bits inside a dynamic_bitset
+     */
+    template<class Allocator = std::allocator<std::uint64_t>>
+    basic_dynamic_bitset<std::uint64_t, Allocator>
+    to_bitset(std::memory_order order = std::memory_order_acquire,
+              const Allocator&  alloc = Allocator()) const
+    {
+        basic_dynamic_bitset<std::uint64_t, Allocator> bits(size_, false,
+                                                            alloc);
+        copy_to(bits.blocks(), order);
+        return bits;
+    }
+
+private:
+    /**
+     * @brief   Removes the release part of @p order, which loads can't have
+     */
+    static constexpr std::memory_order
+    load_order(std::memory_order order) noexcept
+    {
+        switch(order)
+        {
+            case std::memory_order_release:
+                return std::memory_order_relaxed;
+            case std::memory_order_acq_rel:
+                return std::memory_order_acquire;
+            default:
+                return order;
+        }
+    }
+
+    static constexpr std::uint64_t mask(std::size_t pos) noexcept
+    {
+        return std::uint64_t {1} << (pos % 64);
+    }
+
+    word_type& word(std::size_t pos) const
+    {
+        if(pos >= size_)
+            throw std::out_of_range("Argument pos is out of range");
+        return words_[pos / 64];
+    }
+
+    void check_same_size(std::size_t size) const;
+
+    void merge(const std::uint64_t* blocks, std::memory_order order) noexcept;
+
+    void copy_to(std::uint64_t* blocks, std::memory_order order) const noexcept;
+
+    std::unique_ptr<word_type[]> words_;
+    std::size_t                  size_ {0};
+};
+}    // namespace corgi::binary
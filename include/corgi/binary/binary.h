@@ -1,4 +1,11 @@
 #pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
 #include <vector>
 
 namespace corgi::binary
@@ -42,4 +49,91 @@ unsigned long long bits_to_ullong(std::size_t    pos,
                                   unsigned char* src,
                                   std::size_t    size);
 
-}    // namespace corgi::binary
\ No newline at end of file
+namespace detail
+{
+/**
+ * @brief   Reads the @p Len bits located at @p Pos in @p src as an unsigned
+ *          value
+ *
+ * Only the bytes the field covers are read. The size of the copy is a
+ * constant, so compilers turn it into a single load followed by a shift and
+ * a mask.
+ */
+template<std::size_t Pos, std::size_t Len>
+constexpr std::uint64_t load_field(const unsigned char* src) noexcept
+{
+    static_assert(Len > 0 && Len <= 64, "Field length must be in [1, 64]");
+
+    constexpr std::size_t first  = Pos / 8;
+    constexpr std::size_t offset = Pos % 8;
+    constexpr std::size_t bytes  = (offset + Len + 7) / 8;
+
+    // A 64 bits field that isn't byte aligned spans 9 bytes, the last one
+    // is added separately
+    constexpr std::size_t loaded = bytes < 8 ? bytes : 8;
+
+    std::uint64_t value = 0;
+    if(std::is_constant_evaluated() ||
+       std::endian::native != std::endian::little)
+    {
+        for(std::size_t i = 0; i < loaded; i++)
+            value |= std::uint64_t {src[first + i]} << (8 * i);
+    }
+    else
+    {
+        std::memcpy(&value, src + first, loaded);
+    }
+
+    value >>= offset;
+
+    if constexpr(bytes == 9)
+        value |= std::uint64_t {src[first + 8]} << (64 - offset);
+
+    if constexpr(Len < 64)
+        value &= (std::uint64_t {1} << Len) - 1;
+
+    return value;
+}
+}    // namespace detail
+
+/**
+ * @brief   Compile time version of bits_to_llong : converts the @p Len bits
+ *          located at @p Pos in @p src to a @p T
+ *
+ * The field isn't sign extended, like with bits_to_int. No bound checking is
+ * done, use the span overload to get it at compile time.
+ *
+ * @code
+ * const auto version = bits_to<std::uint8_t, 0, 4>(header);
+ * @endcode
+ */
+template<class T, std::size_t Pos, std::size_t Len>
+constexpr T bits_to(const unsigned char* src) noexcept
+{
+    static_assert(std::is_integral_v<T>, "T must be an integer type");
+    static_assert(Len <= std::numeric_limits<std::make_unsigned_t<T>>::digits,
+                  "Field is larger than T");
+
+    return static_cast<T>(detail::load_field<Pos, Len>(src));
+}
+
+/**
+ * @brief   Converts the @p Len bits located at @p Pos in @p src to a @p T,
+ *          checking at compile time that the field is inside @p src
+ *
+ * @code
+ * constexpr unsigned char header[] = {0x12, 0x34};
+ * const auto version = bits_to<std::uint8_t, 12, 4>(std::span(header));
+ * @endcode
+ */
+template<class T, std::size_t Pos, std::size_t Len, std::size_t Extent>
+constexpr T bits_to(std::span<const unsigned char, Extent> src) noexcept
+{
+    static_assert(Extent != std::dynamic_extent,
+                  "The span must have a static extent");
+    static_assert(Pos + Len <= Extent * 8, "Field is out of bounds");
+
+    return bits_to<T, Pos, Len>(src.data());
+}
+
+}    // namespace corgi::binary
@@ -0,0 +1,529 @@
+#pragma once
+
+#include <corgi/binary/detail/block_ops.h>
+#include <corgi/binary/dynamic_bitset.h>
+#include <corgi/binary/instrumentation.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * Lazily evaluated bitwise expressions over dynamic_bitset.
+ *
+ * The operators of dynamic_bitset return a new bitset, so a filter like
+ * (a & b) | (c & ~d) allocates 4 temporaries and goes 4 times through
+ * memory. Wrapping one of the operands with lazy() builds an expression
+ * instead, evaluated in a single pass when it's assigned, counted or
+ * converted to a bitset.
+ *
+ * The blocks are processed by chunks small enough to stay in the L1 cache.
+ * Every node of the expression computes its chunk with the block kernels
+ * (see simd.h), the operands being read directly from the bitsets, so each
+ * bitset is read once from memory and only the result is written. a & ~b and
+ * a - b use a single andnot kernel.
+ *
+ * Expressions hold pointers to the blocks of the bitsets, not copies. They
+ * must be evaluated before the bitsets are destroyed or resized, so
+ * temporary bitsets are rejected as operands.
+ *
+ * @code
+ * using corgi::binary::lazy;
+ *
+ * dynamic_bitset matches = (lazy(a) & b) | (lazy(c) & ~lazy(d));
+ * assign(matches, lazy(a) ^ b);      // Reuses the blocks of matches
+ * const auto hits = (lazy(a) & b).count();
+ * @endcode
+ */
+namespace corgi::binary
+{
+template<class Derived, class Block>
+class bit_expression;
+
+namespace detail
+{
+/**
+ * @brief   Bytes of the chunks an expression is evaluated by
+ */
+inline constexpr std::size_t expression_chunk_bytes = 2048;
+
+template<class T>
+struct is_bit_expression
+{
+    template<class Derived, class Block>
+    static std::true_type test(const bit_expression<Derived, Block>*);
+    static std::false_type test(...);
+
+    static constexpr bool value =
+        decltype(test(static_cast<const T*>(nullptr)))::value;
+};
+
+template<class T>
+struct is_dynamic_bitset : std::false_type
+{
+};
+
+template<class Block, class Allocator>
+struct is_dynamic_bitset<basic_dynamic_bitset<Block, Allocator>>
+    : std::true_type
+{
+};
+}    // namespace detail
+
+/**
+ * @brief   Base of the expression nodes
+ *
+ * @tparam Derived  Node type, which provides size() and
+ *                  chunk(first, count, scratch)
+ * @tparam Block    Block type of the bitsets of the expression
+ */
+template<class Derived, class Block>
+class bit_expression
+{
+public:
+    using block_type = Block;
+
+    /**
+     * @brief   Number of blocks evaluated at a time
+     */
+    static constexpr std::size_t chunk_blocks =
+        detail::expression_chunk_bytes / sizeof(Block);
+
+    /**
+     * @brief   Returns the number of bits of the result
+     */
+    std::size_t size() const noexcept { return derived().size(); }
+
+    /**
+     * @brief   Returns the number of bits set in the result, without
+     *          storing it
+     */
+    std::size_t count() const
+    {
+        std::size_t result = 0;
+        for_each_chunk(
+            [&result](const Block* blocks, std::size_t count)
+            {
+                result += detail::count_blocks(blocks, count);
+                return true;
+            });
+        return result;
+    }
+
+    /**
+     * @brief   Returns true if a bit of the result is set, stopping at the
+     *          first chunk holding one
+     */
+    bool any() const
+    {
+        bool found = false;
+        for_each_chunk(
+            [&found](const Block* blocks, std::size_t count)
+            {
+                found = detail::find_nonzero_block(blocks, 0, count) != count;
+                return !found;
+            });
+        return found;
+    }
+
+    /**
+     * @brief   Returns true if no bit of the result is set
+     */
+    bool none() const { return !any(); }
+
+    /**
+     * @brief   Returns true if every bit of the result is set
+     */
+    bool all() const { return count() == size(); }
+
+    /**
+     * @brief   Evaluates the expression inside a new bitset
+     */
+    template<class Allocator>
+    operator basic_dynamic_bitset<Block, Allocator>() const
+    {
+        basic_dynamic_bitset<Block, Allocator> result(size());
+        evaluate_into(result.blocks());
+        return result;
+    }
+
+    /**
+     * @brief   Writes the result to the block_count(size()) blocks of
+     *          @p blocks
+     *
+     * @p blocks can be the blocks of one of the bitsets of the expression.
+     */
+    void evaluate_into(Block* blocks) const
+    {
+        std::size_t first = 0;
+        for_each_chunk(
+            [&first, blocks](const Block* chunk, std::size_t count)
+            {
+                // chunk is blocks + first when the expression is lazy(bits)
+                std::memmove(blocks + first, chunk, count * sizeof(Block));
+                first += count;
+                return true;
+            });
+    }
+
+    const Derived& derived() const noexcept
+    {
+        return static_cast<const Derived&>(*this);
+    }
+
+private:
+    /**
+     * @brief   Evaluates the chunks in order and hands each one to @p f,
+     *          with the bits past size() set to 0. Stops when @p f returns
+     *          false
+     */
+    template<class Function>
+    void for_each_chunk(Function&& f) const
+    {
+        const std::size_t bit_size    = size();
+        const std::size_t block_count = detail::block_count<Block>(bit_size);
+        const std::size_t used        = bit_size % detail::block_bits<Block>;
+
+        detail::record(detail::counter::word_operations, block_count);
+
+        Block scratch[chunk_blocks];
+        for(std::size_t first = 0; first < block_count; first += chunk_blocks)
+        {
+            const std::size_t count =
+                std::min(chunk_blocks, block_count - first);
+            const Block*      chunk = derived().chunk(first, count, scratch);
+
+            // ~ sets the bits past size(), which must not reach the result
+            if(used != 0 && first + count == block_count)
+            {
+                if(chunk != scratch)
+                    std::copy_n(chunk, count, scratch);
+                scratch[count - 1] &= detail::low_mask<Block>(used);
+                chunk = scratch;
+            }
+
+            if(!f(chunk, count))
+                return;
+        }
+    }
+};
+
+/**
+ * @brief   Leaf of an expression, the blocks of a bitset
+ */
+template<class Block>
+class bitset_terminal : public bit_expression<bitset_terminal<Block>, Block>
+{
+public:
+    bitset_terminal(const Block* blocks, std::size_t size) noexcept
+        : blocks_(blocks)
+        , size_(size)
+    {
+    }
+
+    std::size_t size() const noexcept { return size_; }
+
+    const Block* chunk(std::size_t first, std::size_t, Block*) const noexcept
+    {
+        return blocks_ + first;
+    }
+
+private:
+    const Block* blocks_;
+    std::size_t  size_;
+};
+
+/**
+ * @brief   ~expression
+ */
+template<class Expression>
+class not_expression
+    : public bit_expression<not_expression<Expression>,
+                            typename Expression::block_type>
+{
+public:
+    using block_type = typename Expression::block_type;
+
+    explicit not_expression(const Expression& operand)
+        : operand_(operand)
+    {
+    }
+
+    std::size_t size() const noexcept { return operand_.size(); }
+
+    const Expression& operand() const noexcept { return operand_; }
+
+    const block_type*
+    chunk(std::size_t first, std::size_t count, block_type* scratch) const
+    {
+        detail::not_blocks(scratch, operand_.chunk(first, count, scratch),
+                           count);
+        return scratch;
+    }
+
+private:
+    Expression operand_;
+};
+
+namespace detail
+{
+struct and_expression_op
+{
+    template<class Block>
+    static void
+    apply(Block* dst, const Block* a, const Block* b, std::size_t count)
+    {
+        and_blocks(dst, a, b, count);
+    }
+};
+
+struct or_expression_op
+{
+    template<class Block>
+    static void
+    apply(Block* dst, const Block* a, const Block* b, std::size_t count)
+    {
+        or_blocks(dst, a, b, count);
+    }
+};
+
+struct xor_expression_op
+{
+    template<class Block>
+    static void
+    apply(Block* dst, const Block* a, const Block* b, std::size_t count)
+    {
+        xor_blocks(dst, a, b, count);
+    }
+};
+
+struct andnot_expression_op
+{
+    template<class Block>
+    static void
+    apply(Block* dst, const Block* a, const Block* b, std::size_t count)
+    {
+        andnot_blocks(dst, a, b, count);
+    }
+};
+
+template<class T>
+struct is_not_expression : std::false_type
+{
+};
+
+template<class Expression>
+struct is_not_expression<not_expression<Expression>> : std::true_type
+{
+};
+}    // namespace detail
+
+/**
+ * @brief   Bitwise operation between 2 expressions of the same size
+ */
+template<class Operation, class Left, class Right>
+class binary_expression
+    : public bit_expression<binary_expression<Operation, Left, Right>,
+                            typename Left::block_type>
+{
+public:
+    using block_type = typename Left::block_type;
+
+    static_assert(std::is_same_v<block_type, typename Right::block_type>,
+                  "Both operands must use the same block type");
+
+    using base_type = bit_expression<binary_expression, block_type>;
+
+    /**
+     * @throws std::invalid_argument if the operands don't have the same size
+     */
+    binary_expression(const Left& left, const Right& right)
+        : left_(left)
+        , right_(right)
+    {
+        if(left.size() != right.size())
+            detail::raise<std::invalid_argument>(
+                "Argument other doesn't have the same size as the bitset");
+    }
+
+    std::size_t size() const noexcept { return left_.size(); }
+
+    const block_type*
+    chunk(std::size_t first, std::size_t count, block_type* scratch) const
+    {
+        // The left operand goes to scratch, the right one to a buffer of
+        // its own
+        const block_type* left = left_.chunk(first, count, scratch);
+
+        block_type right_scratch[base_type::chunk_blocks];
+
+        // a & ~b is a single andnot, without computing ~b
+        if constexpr(std::is_same_v<Operation, detail::and_expression_op> &&
+                     detail::is_not_expression<Right>::value)
+        {
+            const block_type* right =
+                right_.operand().chunk(first, count, right_scratch);
+            detail::andnot_expression_op::apply(scratch, left, right, count);
+        }
+        else
+        {
+            const block_type* right =
+                right_.chunk(first, count, right_scratch);
+            Operation::apply(scratch, left, right, count);
+        }
+        return scratch;
+    }
+
+private:
+    Left  left_;
+    Right right_;
+};
+
+/**
+ * @brief   Starts an expression from @p bits
+ */
+template<class Block, class Allocator>
+bitset_terminal<Block> lazy(const basic_dynamic_bitset<Block, Allocator>& bits)
+{
+    return bitset_terminal<Block>(bits.blocks(), bits.size());
+}
+
+// The expression would point to the blocks of a destroyed temporary
+template<class Block, class Allocator>
+void lazy(const basic_dynamic_bitset<Block, Allocator>&&) = delete;
+
+/**
+ * @brief   Evaluates @p expression inside @p bits, resized to the size of
+ *          the expression
+ *
+ * The blocks of @p bits are reused, and @p bits can be one of the operands.
+ */
+template<class Block, class Allocator, class Derived>
+void assign(basic_dynamic_bitset<Block, Allocator>& bits,
+            const bit_expression<Derived, Block>&   expression)
+{
+    bits.resize(expression.size(), false);
+    expression.evaluate_into(bits.blocks());
+}
+
+namespace detail
+{
+/**
+ * @brief   An expression, or a bitset that outlives the expression
+ *
+ * Operands are taken as forwarding references, @p T being an lvalue
+ * reference for the bitsets that can be pointed to.
+ */
+template<class T>
+concept expression_operand =
+    is_bit_expression<std::remove_cvref_t<T>>::value ||
+    (is_dynamic_bitset<std::remove_cvref_t<T>>::value &&
+     std::is_lvalue_reference_v<T>);
+
+/**
+ * @brief   True if the operator is for expressions, operators between 2
+ *          bitsets stay the eager ones of dynamic_bitset
+ */
+template<class Left, class Right>
+concept expression_operands =
+    expression_operand<Left> && expression_operand<Right> &&
+    (is_bit_expression<std::remove_cvref_t<Left>>::value ||
+     is_bit_expression<std::remove_cvref_t<Right>>::value);
+
+template<class T>
+concept temporary_bitset = is_dynamic_bitset<std::remove_cvref_t<T>>::value &&
+                           !std::is_lvalue_reference_v<T>;
+
+/**
+ * @brief   True if an expression is combined with a temporary bitset, which
+ *          would be destroyed before the expression is evaluated
+ */
+template<class Left, class Right>
+concept temporary_bitset_operand =
+    (temporary_bitset<Left> &&
+     is_bit_expression<std::remove_cvref_t<Right>>::value) ||
+    (temporary_bitset<Right> &&
+     is_bit_expression<std::remove_cvref_t<Left>>::value);
+
+template<class T>
+auto as_expression(const T& operand)
+{
+    if constexpr(is_dynamic_bitset<T>::value)
+        return lazy(operand);
+    else
+        return operand;
+}
+
+template<class Operation, class Left, class Right>
+auto make_binary_expression(const Left& left, const Right& right)
+{
+    using left_type  = decltype(as_expression(left));
+    using right_type = decltype(as_expression(right));
+    return binary_expression<Operation, left_type, right_type>(
+        as_expression(left), as_expression(right));
+}
+}    // namespace detail
+
+template<class Left, class Right>
+    requires detail::expression_operands<Left, Right>
+auto operator&(Left&& left, Right&& right)
+{
+    return detail::make_binary_expression<detail::and_expression_op>(left,
+                                                                     right);
+}
+
+template<class Left, class Right>
+    requires detail::expression_operands<Left, Right>
+auto operator|(Left&& left, Right&& right)
+{
+    return detail::make_binary_expression<detail::or_expression_op>(left,
+                                                                    right);
+}
+
+template<class Left, class Right>
+    requires detail::expression_operands<Left, Right>
+auto operator^(Left&& left, Right&& right)
+{
+    return detail::make_binary_expression<detail::xor_expression_op>(left,
+                                                                     right);
+}
+
+/**
+ * @brief   Set difference, left & ~right
+ */
+template<class Left, class Right>
+    requires detail::expression_operands<Left, Right>
+auto operator-(Left&& left, Right&& right)
+{
+    return detail::make_binary_expression<detail::andnot_expression_op>(
+        left, right);
+}
+
+// An expression can't point to a temporary bitset, like lazy(a) & (b | c).
+// Without these, the eager operators of dynamic_bitset would be picked
+// through the conversion of the expression, hiding the mistake
+template<class Left, class Right>
+    requires detail::temporary_bitset_operand<Left, Right>
+void operator&(Left&&, Right&&) = delete;
+
+template<class Left, class Right>
+    requires detail::temporary_bitset_operand<Left, Right>
+void operator|(Left&&, Right&&) = delete;
+
+template<class Left, class Right>
+    requires detail::temporary_bitset_operand<Left, Right>
+void operator^(Left&&, Right&&) = delete;
+
+template<class Left, class Right>
+    requires detail::temporary_bitset_operand<Left, Right>
+void operator-(Left&&, Right&&) = delete;
+
+template<class Expression>
+    requires detail::is_bit_expression<Expression>::value
+not_expression<Expression> operator~(const Expression& expression)
+{
+    return not_expression<Expression>(expression);
+}
+}    // namespace corgi::binary
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <corgi/binary/binary.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+namespace corgi::binary
+{
+namespace detail
+{
+template<class MemberPointer>
+struct member_pointer_traits;
+
+template<class Class, class Member>
+struct member_pointer_traits<Member Class::*>
+{
+    using class_type  = Class;
+    using member_type = Member;
+};
+
+/**
+ * @brief   Returns the number of value bits of the integer or enum @p T
+ */
+template<class T>
+constexpr std::size_t field_digits() noexcept
+{
+    if constexpr(std::is_enum_v<T>)
+        return field_digits<std::underlying_type_t<T>>();
+    else if constexpr(std::is_same_v<T, bool> || !std::is_integral_v<T>)
+        return std::numeric_limits<T>::digits;
+    else
+        return std::numeric_limits<std::make_unsigned_t<T>>::digits;
+}
+}    // namespace detail
+
+/**
+ * @brief   Describes a field of @p Len bits located at bit @p Pos, decoded
+ *          into the data member @p Member
+ *
+ * @tparam Member   Pointer to the integer (or enum) data member receiving
+ *                  the field
+ */
+template<auto Member, std::size_t Pos, std::size_t Len>
+struct bit_field
+{
+    using traits      = detail::member_pointer_traits<decltype(Member)>;
+    using class_type  = typename traits::class_type;
+    using member_type = typename traits::member_type;
+
+    static constexpr std::size_t pos = Pos;
+    static constexpr std::size_t len = Len;
+
+    static_assert(std::is_integral_v<member_type> ||
+                      std::is_enum_v<member_type>,
+                  "Fields can only be decoded into integers or enums");
+    static_assert(Len <= detail::field_digits<member_type>(),
+                  "Field is larger than the member");
+
+    /**
+     * @brief   Decodes the field from @p src into @p object
+     */
+    static constexpr void decode(const unsigned char* src,
+                                 class_type&          object) noexcept
+    {
+        object.*Member =
+            static_cast<member_type>(detail::load_field<Pos, Len>(src));
+    }
+};
+
+/**
+ * @brief   Declarative description of a packed header, decoding every field
+ *          of @p Fields at once
+ *
+ * Positions and lengths are constants, so decoding has no branches : every
+ * field is a load, a shift and a mask. Bound checks against the size of the
+ * buffer are done at compile time when a static extent span is used.
+ *
+ * @code
+ * struct packet_header
+ * {
+ *     std::uint8_t  version;
+ *     std::uint16_t length;
+ *     bool          urgent;
+ * };
+ *
+ * using packet_layout =
+ *     bit_layout<bit_field<&packet_header::version, 0, 3>,
+ *                bit_field<&packet_header::length, 3, 12>,
+ *                bit_field<&packet_header::urgent, 15, 1>>;
+ *
+ * const packet_header header = packet_layout::decode(bytes);
+ * @endcode
+ */
+template<class... Fields>
+struct bit_layout
+{
+    static_assert(sizeof...(Fields) > 0, "A layout needs at least a field");
+
+    using value_type =
+        typename std::tuple_element_t<0, std::tuple<Fields...>>::class_type;
+
+    static_assert(
+        (std::is_same_v<typename Fields::class_type, value_type> && ...),
+        "Every field must belong to the same class");
+
+    /**
+     * @brief   Number of bits covered by the fields
+     */
+    static constexpr std::size_t bit_size =
+        std::max({(Fields::pos + Fields::len)...});
+
+    /**
+     * @brief   Minimum number of bytes a buffer needs to hold every field
+     */
+    static constexpr std::size_t byte_size = (bit_size + 7) / 8;
+
+    /**
+     * @brief   Decodes every field from @p src. No bound checking is done
+     */
+    static constexpr value_type decode(const unsigned char* src) noexcept
+    {
+        value_type result {};
+        (Fields::decode(src, result), ...);
+        return result;
+    }
+
+    /**
+     * @brief   Decodes every field from @p src, checking at compile time that
+     *          @p src is large enough
+     */
+    template<std::size_t Extent>
+    static constexpr value_type
+    decode(std::span<const unsigned char, Extent> src) noexcept
+    {
+        static_assert(Extent != std::dynamic_extent,
+                      "The span must have a static extent");
+        static_assert(byte_size <= Extent, "The layout is out of bounds");
+        return decode(src.data());
+    }
+};
+
+}    // namespace corgi::binary
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Reads fields of any width, one after the other, from an array of
+ *          bytes
+ *
+ * Bits are read in the same order as bits_to_llong : starting from the least
+ * significant bit of the first byte. The first bit read ends up as the least
+ * significant bit of the returned value.
+ *
+ * The reader keeps up to 64 bits in a buffer and refills it with a single
+ * unaligned 8 bytes load, so most calls are a shift and a mask. The bounds
+ * are only checked when the buffer runs low.
+ *
+ * @code
+ * bit_reader reader(bytes);
+ * const auto version = reader.read(3);
+ * const auto length  = reader.read(13);
+ * reader.align();
+ * @endcode
+ */
+class bit_reader
+{
+public:
+    /**
+     * @brief   Largest field that can be read in a single call
+     */
+    static constexpr std::size_t max_field_size = 64;
+
+    /**
+     * @brief   Constructs a reader over @p bytes. The bytes must outlive the
+     *          reader
+     */
+    explicit bit_reader(std::span<const unsigned char> bytes) noexcept
+        : data_(bytes.data())
+        , size_(bytes.size())
+    {
+    }
+
+    /**
+     * @brief   Returns the next @p count bits without consuming them
+     *
+     * @throws std::invalid_argument Thrown if @p count is greater than 56
+     * @throws std::out_of_range Thrown if less than @p count bits remain
+     */
+    std::uint64_t peek(std::size_t count)
+    {
+        if(count > buffer_bits)
+            throw std::invalid_argument("Argument count is greater than 56");
+
+        if(count > bit_count_)
+        {
+            refill();
+            if(count > bit_count_)
+                throw std::out_of_range("Not enough bits left to read");
+        }
+        return buffer_ & mask(count);
+    }
+
+    /**
+     * @brief   Reads and consumes the next @p count bits
+     *
+     * @throws std::invalid_argument Thrown if @p count is greater than 64
+     * @throws std::out_of_range Thrown if less than @p count bits remain.
+     *         Nothing is consumed in that case
+     */
+    std::uint64_t read(std::size_t count)
+    {
+        if(count <= bit_count_)
+        {
+            const auto value = buffer_ & mask(count);
+            consume(count);
+            return value;
+        }
+
+        if(count <= buffer_bits)
+        {
+            const auto value = peek(count);
+            consume(count);
+            return value;
+        }
+
+        // Wider fields may not fit in the buffer once it's refilled, they are
+        // read in 2 halves
+        if(count > max_field_size)
+            throw std::invalid_argument("Argument count is greater than 64");
+
+        if(count > remaining())
+            throw std::out_of_range("Not enough bits left to read");
+
+        const auto low = read(32);
+        return low | (read(count - 32) << 32);
+    }
+
+    /**
+     * @brief   Consumes @p count bits without reading them
+     *
+     * @throws std::out_of_range Thrown if less than @p count bits remain
+     */
+    void skip(std::size_t count)
+    {
+        if(count <= bit_count_)
+        {
+            consume(count);
+            return;
+        }
+
+        if(count > remaining())
+            throw std::out_of_range("Not enough bits left to skip");
+
+        // Drops the buffer and moves straight to the byte the next field
+        // starts in
+        const auto position = this->position() + count;
+        byte_pos_           = position / 8;
+        buffer_             = 0;
+        bit_count_          = 0;
+
+        const auto offset = position % 8;
+        if(offset != 0)
+        {
+            refill();
+            consume(offset);
+        }
+    }
+
+    /**
+     * @brief   Skips the bits left in the current byte, so the next read
+     *          starts on a byte boundary
+     */
+    void align() noexcept
+    {
+        // Bytes are always loaded whole, so the number of bits left in the
+        // current byte is what remains of the buffer modulo 8
+        consume(bit_count_ % 8);
+    }
+
+    /**
+     * @brief   Returns the number of bits consumed so far
+     */
+    std::size_t position() const noexcept
+    {
+        return byte_pos_ * 8 - bit_count_;
+    }
+
+    /**
+     * @brief   Returns how many bits are left to read
+     */
+    std::size_t remaining() const noexcept { return size_ * 8 - position(); }
+
+    /**
+     * @brief   Returns true if every bit has been consumed
+     */
+    bool empty() const noexcept { return remaining() == 0; }
+
+private:
+    /**
+     * @brief   A refill always leaves at least this many bits in the buffer,
+     *          unless the end of the bytes was reached
+     */
+    static constexpr std::size_t buffer_bits = 56;
+
+    static constexpr std::uint64_t mask(std::size_t count) noexcept
+    {
+        return count >= 64 ? ~std::uint64_t {0}
+                           : (std::uint64_t {1} << count) - 1;
+    }
+
+    void consume(std::size_t count) noexcept
+    {
+        // Shifting a 64 bits value by 64 is undefined
+        buffer_ = count == 64 ? 0 : buffer_ >> count;
+        bit_count_ -= count;
+    }
+
+    /**
+     * @brief   Loads as many whole bytes as fit in the buffer
+     */
+    void refill() noexcept
+    {
+        static_assert(std::endian::native == std::endian::little,
+                      "bit_reader requires a little endian target");
+
+        if(byte_pos_ + 8 <= size_)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data_ + byte_pos_, sizeof(word));
+
+            // Bits above bit_count_ already hold the next bytes, so OR-ing
+            // them again is harmless
+            buffer_ |= word << bit_count_;
+
+            // Only whole bytes are counted, the bits of the last partial byte
+            // will be loaded again by the next refill
+            const auto bytes = (63 - bit_count_) / 8;
+            byte_pos_ += bytes;
+            bit_count_ += bytes * 8;
+            return;
+        }
+
+        refill_tail();
+    }
+
+    /**
+     * @brief   Loads the last bytes one at a time, when less than 8 remain
+     */
+    void refill_tail() noexcept;
+
+    const unsigned char* data_;
+    std::size_t          size_;
+
+    /**
+     * @brief   Next byte that will be loaded in the buffer
+     */
+    std::size_t byte_pos_ {0};
+
+    /**
+     * @brief   Bits loaded but not consumed yet, the next bit to read being
+     *          the least significant one
+     */
+    std::uint64_t buffer_ {0};
+
+    /**
+     * @brief   Number of valid bits in buffer_
+     */
+    std::size_t bit_count_ {0};
+};
+
+}    // namespace corgi::binary
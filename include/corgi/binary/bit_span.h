@@ -0,0 +1,472 @@
+#pragma once
+
+#include <corgi/binary/detail/block_ops.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Non owning view over a range of bits stored in an array of bytes
+ *
+ * Bit i of the view is the bit @p offset + i of the bytes, bit k being stored
+ * in byte k / 8 at position k % 8. That's the layout of dynamic_bitset::data()
+ * and bits_to_llong, so a view works over a bitset, a network packet, or a
+ * memory mapped file without copying anything.
+ *
+ * The view reads 64 bits at a time with unaligned loads, whatever its
+ * offset, and never touches the bytes outside of its bits. Writing through a
+ * mutable view only modifies the bits of the view.
+ *
+ * @code
+ * const_bit_span header(packet, 24);
+ * const auto flags = header.to_ullong(3, 5);
+ * for(auto pos = header.find_first(); pos != header.npos;
+ *     pos = header.find_next(pos))
+ *     visit(pos);
+ * @endcode
+ *
+ * @tparam Byte     unsigned char for a mutable view, const unsigned char for
+ *                  a read only one
+ */
+template<class Byte>
+class basic_bit_span
+{
+    static_assert(std::is_same_v<std::remove_const_t<Byte>, unsigned char>,
+                  "Byte must be unsigned char or const unsigned char");
+
+    // Unaligned loads assemble the bytes in little endian order
+    static_assert(std::endian::native == std::endian::little,
+                  "bit_span requires a little endian target");
+
+public:
+    /**
+     * @brief   Value returned by the find functions when no bit was found
+     */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief   Constructs an empty view
+     */
+    basic_bit_span() noexcept = default;
+
+    /**
+     * @brief   Constructs a view over the @p size bits starting at bit
+     *          @p offset of @p data
+     */
+    basic_bit_span(Byte*       data,
+                   std::size_t size,
+                   std::size_t offset = 0) noexcept
+        : data_(data + offset / 8)
+        , offset_(offset % 8)
+        , size_(size)
+    {
+    }
+
+    /**
+     * @brief   Constructs a view over every bit of @p bytes
+     */
+    explicit basic_bit_span(std::span<Byte> bytes) noexcept
+        : basic_bit_span(bytes.data(), bytes.size() * 8)
+    {
+    }
+
+    /**
+     * @brief   A mutable view converts to a read only one
+     */
+    template<class Other>
+        requires(std::is_const_v<Byte> &&
+                 std::is_same_v<const Other, Byte>)
+    basic_bit_span(const basic_bit_span<Other>& other) noexcept
+        : basic_bit_span(other.data(), other.size(), other.offset())
+    {
+    }
+
+    /**
+     * @brief   Returns the byte holding the first bit of the view
+     */
+    Byte* data() const noexcept { return data_; }
+
+    /**
+     * @brief   Returns the position of the first bit of the view inside
+     *          data(), in [0, 8)
+     */
+    std::size_t offset() const noexcept { return offset_; }
+
+    /**
+     * @brief   Returns the number of bits of the view
+     */
+    std::size_t size() const noexcept { return size_; }
+
+    bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief   Returns a view over the @p count bits starting at @p first
+     *
+     * @throws std::out_of_range Thrown if the bits go past size()
+     */
+    basic_bit_span subspan(std::size_t first, std::size_t count) const
+    {
+        if(first > size_ || count > size_ - first)
+            throw std::out_of_range("Arguments are out of range");
+
+        return basic_bit_span(data_, count, offset_ + first);
+    }
+
+    /**
+     * @brief   Returns the value of the bit located at @p pos
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    bool test(std::size_t pos) const
+    {
+        if(pos >= size_)
+            throw std::out_of_range("Argument pos is out of range");
+        return test_unchecked(pos);
+    }
+
+    /**
+     * @brief   Returns the value of the bit located at @p pos, which must be
+     *          lower than size()
+     */
+    bool test_unchecked(std::size_t pos) const noexcept
+    {
+        assert(pos < size_);
+        const auto bit = offset_ + pos;
+        return (data_[bit / 8] >> (bit % 8)) & 1;
+    }
+
+    bool operator[](std::size_t pos) const noexcept
+    {
+        return test_unchecked(pos);
+    }
+
+    /**
+     * @brief   Returns the number of words of 64 bits needed to hold the view
+     */
+    std::size_t word_count() const noexcept
+    {
+        return detail::block_count<std::uint64_t>(size_);
+    }
+
+    /**
+     * @brief   Returns the bits [64 * @p index, 64 * @p index + 64) of the
+     *          view, the bits past size() being 0
+     *
+     * @p index must be lower than word_count()
+     */
+    std::uint64_t word(std::size_t index) const noexcept
+    {
+        assert(index < word_count());
+        const auto pos = index * 64;
+        return load(pos) & detail::low_mask<std::uint64_t>(size_ - pos);
+    }
+
+    /**
+     * @brief   Copies the bits of the view to @p dst, starting at the first
+     *          bit of the first byte
+     *
+     * Writes detail::byte_count(size()) bytes, the bits past size() in the
+     * last byte are set to 0.
+     */
+    void copy_to(unsigned char* dst) const noexcept
+    {
+        const auto bytes = detail::byte_count(size_);
+        for(std::size_t i = 0; i < word_count(); i++)
+        {
+            const auto value = word(i);
+            std::memcpy(dst + 8 * i, &value,
+                        std::min<std::size_t>(8, bytes - 8 * i));
+        }
+    }
+
+    /**
+     * @brief   Returns the number of bits that are set
+     */
+    std::size_t count() const noexcept
+    {
+        std::size_t result = 0;
+        for(std::size_t i = 0; i < word_count(); i++)
+            result += static_cast<std::size_t>(std::popcount(word(i)));
+        return result;
+    }
+
+    /**
+     * @brief   Returns the number of bits that are set in [@p first, @p last)
+     *
+     * @throws std::out_of_range Thrown if @p last is greater than size()
+     * @throws std::invalid_argument Thrown if @p first is greater than
+     * @p last
+     */
+    std::size_t count(std::size_t first, std::size_t last) const
+    {
+        if(last > size_)
+            throw std::out_of_range("Argument last is out of range");
+
+        if(first > last)
+            throw std::invalid_argument(
+                "Argument first is greater than argument last");
+
+        std::size_t result = 0;
+        for(auto pos = first; pos < last; pos += 64)
+            result += static_cast<std::size_t>(std::popcount(
+                load(pos) & detail::low_mask<std::uint64_t>(last - pos)));
+        return result;
+    }
+
+    /**
+     * @brief   Returns true if every bit is set, or if the view is empty
+     */
+    bool all() const noexcept
+    {
+        for(std::size_t i = 0; i < word_count(); i++)
+        {
+            if(word(i) != detail::low_mask<std::uint64_t>(size_ - i * 64))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief   Returns true if at least one bit is set
+     */
+    bool any() const noexcept { return find_first() != npos; }
+
+    /**
+     * @brief   Returns true if no bit is set
+     */
+    bool none() const noexcept { return !any(); }
+
+    /**
+     * @brief   Returns the position of the first set bit, or npos if no bit is
+     * set
+     */
+    std::size_t find_first() const noexcept { return find_next(npos); }
+
+    /**
+     * @brief   Returns the position of the first set bit located after
+     * @p pos, or npos if there's none
+     */
+    std::size_t find_next(std::size_t pos) const noexcept
+    {
+        // npos + 1 wraps around to 0, like dynamic_bitset::find_next
+        for(auto first = pos + 1; first < size_; first += 64)
+        {
+            const auto bits =
+                load(first) & detail::low_mask<std::uint64_t>(size_ - first);
+            if(bits != 0)
+                return first + static_cast<std::size_t>(std::countr_zero(bits));
+        }
+        return npos;
+    }
+
+    /**
+     * @brief   Returns the position of the last set bit, or npos if no bit is
+     * set
+     */
+    std::size_t find_last() const noexcept { return find_prev(size_); }
+
+    /**
+     * @brief   Returns the position of the last set bit located before
+     * @p pos, or npos if there's none
+     */
+    std::size_t find_prev(std::size_t pos) const noexcept
+    {
+        // Looks at the 64 bits before last, going backward
+        for(auto last = std::min(pos, size_); last != 0;)
+        {
+            const auto first = last >= 64 ? last - 64 : 0;
+            const auto bits =
+                load(first) & detail::low_mask<std::uint64_t>(last - first);
+            if(bits != 0)
+                return first + 63 -
+                       static_cast<std::size_t>(std::countl_zero(bits));
+            last = first;
+        }
+        return npos;
+    }
+
+    /**
+     * @brief   Converts the bits to an unsigned long long
+     *
+     * @throws std::overflow_error Thrown if the view has more than 64 bits
+     */
+    unsigned long long to_ullong() const
+    {
+        if(size_ > 64)
+            throw std::overflow_error("bit_span : Too much bits in view to "
+                                      "convert to an unsigned long long");
+        return empty() ? 0 : word(0);
+    }
+
+    /**
+     * @brief   Converts the @p len bits starting at @p pos to an unsigned
+     *          long long
+     *
+     * @throws std::invalid_argument Thrown if @p len is greater than 64
+     * @throws std::out_of_range Thrown if the bits go past size()
+     */
+    unsigned long long to_ullong(std::size_t pos, std::size_t len) const
+    {
+        if(len > 64)
+            throw std::invalid_argument("Argument len is greater than 64");
+
+        if(pos > size_ || len > size_ - pos)
+            throw std::out_of_range("Arguments are out of range");
+
+        return len == 0 ? 0 : load(pos) & detail::low_mask<std::uint64_t>(len);
+    }
+
+    /**
+     * @brief   Sets the bit located at @p pos to @p value
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    void set(std::size_t pos, bool value = true)
+        requires(!std::is_const_v<Byte>)
+    {
+        if(pos >= size_)
+            throw std::out_of_range("Argument pos is out of range");
+
+        const auto bit  = offset_ + pos;
+        const auto mask = static_cast<unsigned char>(1u << (bit % 8));
+        if(value)
+            data_[bit / 8] |= mask;
+        else
+            data_[bit / 8] &= static_cast<unsigned char>(~mask);
+    }
+
+    /**
+     * @brief   Sets every bit of the view to @p value
+     */
+    void set(bool value = true) noexcept
+        requires(!std::is_const_v<Byte>)
+    {
+        if(empty())
+            return;
+
+        const auto first = offset_;
+        const auto last  = offset_ + size_;
+        const auto fill  = static_cast<unsigned char>(value ? 0xFF : 0);
+
+        // Only the bits of the view are touched in the first and last bytes
+        const auto write = [this, fill](std::size_t byte, unsigned mask)
+        {
+            data_[byte] = static_cast<unsigned char>((data_[byte] & ~mask) |
+                                                     (fill & mask));
+        };
+
+        const auto first_mask = 0xFFu << first;
+        const auto last_mask  = 0xFFu >> (7 - (last - 1) % 8);
+
+        if(first / 8 == (last - 1) / 8)
+        {
+            write(0, first_mask & last_mask & 0xFFu);
+            return;
+        }
+
+        write(0, first_mask & 0xFFu);
+        std::memset(data_ + 1, fill, (last - 1) / 8 - 1);
+        write((last - 1) / 8, last_mask);
+    }
+
+    /**
+     * @brief   Sets the bit located at @p pos to false
+     */
+    void reset(std::size_t pos)
+        requires(!std::is_const_v<Byte>)
+    {
+        set(pos, false);
+    }
+
+    /**
+     * @brief   Sets every bit of the view to false
+     */
+    void reset() noexcept
+        requires(!std::is_const_v<Byte>)
+    {
+        set(false);
+    }
+
+    /**
+     * @brief   Flips the bit located at @p pos
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    void flip(std::size_t pos)
+        requires(!std::is_const_v<Byte>)
+    {
+        set(pos, !test(pos));
+    }
+
+    /**
+     * @brief   Returns true if both views hold the same bits, whatever their
+     *          offsets
+     */
+    friend bool operator==(const basic_bit_span& lhs,
+                           const basic_bit_span& rhs) noexcept
+    {
+        if(lhs.size() != rhs.size())
+            return false;
+
+        for(std::size_t i = 0; i < lhs.word_count(); i++)
+        {
+            if(lhs.word(i) != rhs.word(i))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    /**
+     * @brief   Returns the 64 bits starting at @p pos. Bits past the bytes
+     *          of the view are 0, but bits past size() inside them aren't
+     *          masked
+     */
+    std::uint64_t load(std::size_t pos) const noexcept
+    {
+        const auto bit   = offset_ + pos;
+        const auto byte  = bit / 8;
+        const auto shift = bit % 8;
+        const auto bytes = detail::byte_count(offset_ + size_);
+
+        std::uint64_t value = 0;
+        if(byte + 8 <= bytes)
+            std::memcpy(&value, data_ + byte, sizeof(value));
+        else
+        {
+            for(auto i = byte; i < bytes; i++)
+                value |= std::uint64_t {data_[i]} << (8 * (i - byte));
+        }
+
+        value >>= shift;
+
+        // The 64 bits straddle 9 bytes when the position isn't byte aligned
+        if(shift != 0 && byte + 8 < bytes)
+            value |= std::uint64_t {data_[byte + 8]} << (64 - shift);
+        return value;
+    }
+
+    Byte*       data_ {nullptr};
+    std::size_t offset_ {0};
+    std::size_t size_ {0};
+};
+
+/**
+ * @brief   View that can modify the bits it covers
+ */
+using bit_span = basic_bit_span<unsigned char>;
+
+/**
+ * @brief   Read only view
+ */
+using const_bit_span = basic_bit_span<const unsigned char>;
+}    // namespace corgi::binary
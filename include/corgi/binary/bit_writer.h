@@ -0,0 +1,197 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Packs fields of any width one after the other into bytes
+ *
+ * Bits are written in the order bit_reader reads them : the least
+ * significant bit of the first field goes to the least significant bit of
+ * the first byte.
+ *
+ * Fields are accumulated in a 64 bits register that is stored 8 bytes at a
+ * time, so writing a field is a couple of shifts. Bytes go to one of 3
+ * destinations :
+ *  - a std::vector that grows as needed, bytes being appended after its
+ *    current content
+ *  - a caller provided span, std::length_error is thrown when it's full
+ *  - a std::ostream, bytes being staged in an internal buffer and written
+ *    in large blocks
+ *
+ * The last bits only reach the destination on flush(), which the destructor
+ * calls.
+ *
+ * @code
+ * std::vector<unsigned char> packet;
+ * bit_writer writer(packet);
+ * writer.write(version, 3);
+ * writer.write(length, 13);
+ * writer.flush();
+ * @endcode
+ */
+class bit_writer
+{
+public:
+    /**
+     * @brief   Size of the staging buffer used for streams by default
+     */
+    static constexpr std::size_t default_stream_buffer_size = 64 * 1024;
+
+    /**
+     * @brief   Appends the bytes to @p buffer, which must outlive the writer
+     */
+    explicit bit_writer(std::vector<unsigned char>& buffer);
+
+    /**
+     * @brief   Writes the bytes to @p buffer, which must outlive the writer
+     */
+    explicit bit_writer(std::span<unsigned char> buffer) noexcept;
+
+    /**
+     * @brief   Writes the bytes to @p stream by blocks of @p buffer_size
+     *          bytes
+     */
+    explicit bit_writer(std::ostream& stream,
+                        std::size_t   buffer_size = default_stream_buffer_size);
+
+    bit_writer(const bit_writer&)            = delete;
+    bit_writer& operator=(const bit_writer&) = delete;
+
+    /**
+     * @brief   Flushes the bits that are still in the writer. Errors are
+     *          ignored, call flush() to see them
+     */
+    ~bit_writer();
+
+    /**
+     * @brief   Writes the @p count low bits of @p value. Bits of @p value
+     *          above @p count are ignored
+     *
+     * @throws std::invalid_argument Thrown if @p count is greater than 64
+     * @throws std::length_error Thrown if the span given to the writer is
+     *         full
+     */
+    void write(std::uint64_t value, std::size_t count)
+    {
+        if(count > 64)
+            throw std::invalid_argument("Argument count is greater than 64");
+
+        if(count == 0)
+            return;
+
+        value &= count == 64 ? ~std::uint64_t {0}
+                             : (std::uint64_t {1} << count) - 1;
+
+        accumulator_ |= value << bit_count_;
+
+        if(bit_count_ + count < 64)
+        {
+            bit_count_ += count;
+            return;
+        }
+
+        // The register is full, the bits of value that didn't fit start the
+        // next one
+        store_accumulator();
+        accumulator_ = bit_count_ == 0 ? 0 : value >> (64 - bit_count_);
+        bit_count_   = bit_count_ + count - 64;
+    }
+
+    /**
+     * @brief   Writes the @p count low bits of every value of @p values
+     *
+     * Faster than calling write() in a loop when packing fixed width fields,
+     * the register is kept in a local variable for the whole batch.
+     *
+     * @throws std::invalid_argument Thrown if @p count is greater than 64
+     * @throws std::length_error Thrown if the span given to the writer is
+     *         full
+     */
+    void write(std::span<const std::uint64_t> values, std::size_t count);
+
+    /**
+     * @brief   Writes a single bit
+     */
+    void write_bit(bool value) { write(value, 1); }
+
+    /**
+     * @brief   Pads the output with 0 up to the next byte boundary
+     */
+    void align() { write(0, (8 - bit_count_ % 8) % 8); }
+
+    /**
+     * @brief   Aligns the output on a byte boundary and sends every pending
+     *          byte to the destination
+     *
+     * When writing to a vector, its size becomes the number of bytes written
+     * so far.
+     *
+     * @throws std::length_error Thrown if the span given to the writer is
+     *         full
+     */
+    void flush();
+
+    /**
+     * @brief   Returns the number of bits written so far
+     */
+    std::size_t position() const noexcept
+    {
+        return (flushed_ + static_cast<std::size_t>(out_ - begin_)) * 8 +
+               bit_count_;
+    }
+
+private:
+    void store_accumulator()
+    {
+        static_assert(std::endian::native == std::endian::little,
+                      "bit_writer requires a little endian target");
+
+        if(end_ - out_ < 8)
+            make_room(8);
+
+        std::memcpy(out_, &accumulator_, sizeof(accumulator_));
+        out_ += 8;
+    }
+
+    /**
+     * @brief   Makes sure @p count bytes can be written at out_
+     */
+    void make_room(std::size_t count);
+
+    unsigned char* begin_ {nullptr};
+    unsigned char* out_ {nullptr};
+    unsigned char* end_ {nullptr};
+
+    std::vector<unsigned char>* vector_ {nullptr};
+    std::ostream*               stream_ {nullptr};
+
+    /**
+     * @brief   Staging buffer, only used with streams
+     */
+    std::vector<unsigned char> stream_buffer_;
+
+    /**
+     * @brief   Size of the vector when the writer was created, begin_ points
+     *          right after these bytes
+     */
+    std::size_t vector_offset_ {0};
+
+    /**
+     * @brief   Bytes already written to the stream
+     */
+    std::size_t flushed_ {0};
+
+    std::uint64_t accumulator_ {0};
+    std::size_t   bit_count_ {0};
+};
+
+}    // namespace corgi::binary
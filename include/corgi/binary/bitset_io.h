@@ -0,0 +1,188 @@
+#pragma once
+
+#include <corgi/binary/bit_span.h>
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <span>
+
+/**
+ * Saving and loading dynamic_bitset in a versioned binary format.
+ *
+ * A file is a 64 bytes header followed by the payload. Every integer is
+ * stored in little endian.
+ *
+ * | Offset | Size | Field                                             |
+ * |--------|------|---------------------------------------------------|
+ * | 0      | 8    | Magic, the characters "CORGIBIT"                  |
+ * | 8      | 2    | Format version, currently 1                       |
+ * | 10     | 1    | Bytes per word of the payload, 8                  |
+ * | 11     | 1    | Endianness of the payload words, 1 for little     |
+ * | 12     | 4    | Size of the header in bytes, 64                   |
+ * | 16     | 8    | Number of bits of the bitset                      |
+ * | 24     | 8    | Size of the payload in bytes                      |
+ * | 32     | 8    | XXH64 (seed 0) of the payload                     |
+ * | 40     | 24   | Reserved, 0                                       |
+ *
+ * The payload holds the blocks of the bitset, the bits located after the
+ * size of the bitset being 0. Since it starts 64 bytes after the beginning
+ * of the file, a memory mapped file can be used in place through
+ * view_bitset_file().
+ *
+ * Errors in the format, including a checksum mismatch, throw
+ * std::runtime_error. Stream failures throw std::ios_base::failure and file
+ * descriptor failures std::system_error.
+ */
+namespace corgi::binary
+{
+/**
+ * @brief   Fields of the header of a saved bitset
+ */
+struct bitset_file_header
+{
+    /**
+     * @brief   Size of the header, the payload starts right after it
+     */
+    static constexpr std::size_t size = 64;
+
+    static constexpr std::uint16_t current_version = 1;
+
+    std::uint16_t version {current_version};
+    std::uint8_t  word_bytes {sizeof(std::uint64_t)};
+    std::uint8_t  endianness {1};
+    std::uint64_t bit_size {0};
+    std::uint64_t payload_bytes {0};
+    std::uint64_t checksum {0};
+};
+
+namespace detail
+{
+/**
+ * @brief   Returns the XXH64 hash of @p bytes, the checksum of the format
+ */
+std::uint64_t xxhash64(std::span<const unsigned char> bytes,
+                       std::uint64_t                  seed = 0) noexcept;
+
+void save_bitset(const std::uint64_t* blocks,
+                 std::size_t          bit_size,
+                 std::ostream&        stream);
+
+void save_bitset(const std::uint64_t* blocks, std::size_t bit_size, int fd);
+
+bitset_file_header read_bitset_header(std::istream& stream);
+
+bitset_file_header read_bitset_header(int fd);
+
+/**
+ * @brief   Reads the payload described by @p header, and checks it
+ *
+ * @p grow is called with the number of payload bytes about to be available
+ * and returns the blocks to read them to. The whole payload is only asked
+ * for upfront when the size of the file vouches for it, otherwise the
+ * blocks grow chunk by chunk as the data arrives, so a corrupted header
+ * can't make the reader allocate more than what the source holds.
+ */
+void read_bitset_payload(
+    const bitset_file_header&                          header,
+    const std::function<std::uint64_t*(std::size_t)>& grow,
+    std::istream&                                      stream);
+
+void read_bitset_payload(
+    const bitset_file_header&                          header,
+    const std::function<std::uint64_t*(std::size_t)>& grow,
+    int                                                fd);
+
+/**
+ * @brief   Reads a bitset from @p source into a new bitset, which only
+ *          replaces @p bits once the payload has been checked
+ */
+template<class Allocator, class Source>
+void load_bitset(basic_dynamic_bitset<std::uint64_t, Allocator>& bits,
+                 Source&                                         source)
+{
+    const auto header   = read_bitset_header(source);
+    const auto bit_size = static_cast<std::size_t>(header.bit_size);
+
+    basic_dynamic_bitset<std::uint64_t, Allocator> loaded(
+        bits.get_allocator());
+    read_bitset_payload(
+        header,
+        [&loaded, bit_size](std::size_t bytes)
+        {
+            loaded.resize(bytes > bit_size / 8 ? bit_size : bytes * 8, false);
+            return loaded.blocks();
+        },
+        source);
+    bits = std::move(loaded);
+}
+}    // namespace detail
+
+/**
+ * @brief   Writes @p bits to @p stream
+ */
+template<class Allocator>
+void save(const basic_dynamic_bitset<std::uint64_t, Allocator>& bits,
+          std::ostream&                                         stream)
+{
+    detail::save_bitset(bits.blocks(), bits.size(), stream);
+}
+
+/**
+ * @brief   Writes @p bits to the file descriptor @p fd
+ */
+template<class Allocator>
+void save(const basic_dynamic_bitset<std::uint64_t, Allocator>& bits, int fd)
+{
+    detail::save_bitset(bits.blocks(), bits.size(), fd);
+}
+
+/**
+ * @brief   Replaces the content of @p bits by the bitset read from
+ *          @p stream
+ *
+ * The payload is read by large chunks, and hashed while it's still in
+ * cache. @p bits is left unchanged when an exception is thrown.
+ */
+template<class Allocator>
+void load(basic_dynamic_bitset<std::uint64_t, Allocator>& bits,
+          std::istream&                                   stream)
+{
+    detail::load_bitset(bits, stream);
+}
+
+/**
+ * @brief   Replaces the content of @p bits by the bitset read from the file
+ *          descriptor @p fd
+ *
+ * @p bits is left unchanged when an exception is thrown.
+ */
+template<class Allocator>
+void load(basic_dynamic_bitset<std::uint64_t, Allocator>& bits, int fd)
+{
+    detail::load_bitset(bits, fd);
+}
+
+/**
+ * @brief   Returns the header of the saved bitset held by @p file
+ *
+ * @throws std::runtime_error Thrown if @p file doesn't start with a valid
+ * header
+ */
+bitset_file_header read_bitset_header(std::span<const unsigned char> file);
+
+/**
+ * @brief   Returns a view over the bits of the saved bitset held by @p file,
+ *          typically a memory mapped file, without copying them
+ *
+ * @param verify_checksum   Hashes the whole payload to check it. Skipping
+ *                          it avoids reading the pages that aren't used
+ *
+ * @throws std::runtime_error Thrown if @p file isn't a valid saved bitset
+ */
+const_bit_span view_bitset_file(std::span<const unsigned char> file,
+                                bool verify_checksum = true);
+}    // namespace corgi::binary
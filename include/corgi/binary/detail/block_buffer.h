@@ -0,0 +1,279 @@
+#pragma once
+
+#include <corgi/binary/instrumentation.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace corgi::binary::detail
+{
+/**
+ * @brief   Growable array of blocks with a small inline buffer
+ *
+ * Up to 128 bits worth of blocks are stored inside the object itself, so
+ * small bitsets never touch the heap. Once the buffer needs more room it
+ * moves its blocks to memory obtained from @p Allocator and stays there,
+ * like a std::vector would.
+ *
+ * The allocator follows the usual allocator aware container rules, so
+ * std::pmr allocators and allocators with fancy pointers (shared memory
+ * segments) can be used.
+ */
+template<class Block, class Allocator>
+class block_buffer
+{
+    using traits = std::allocator_traits<Allocator>;
+
+public:
+    using block_type     = Block;
+    using allocator_type = Allocator;
+    using pointer        = typename traits::pointer;
+
+    static_assert(std::is_same_v<typename traits::value_type, Block>,
+                  "Allocator::value_type must be the block type");
+
+    /**
+     * @brief   How many blocks fit inside the object
+     */
+    static constexpr std::size_t inline_capacity =
+        std::max<std::size_t>(1, 16 / sizeof(Block));
+
+    block_buffer() noexcept(noexcept(Allocator())) = default;
+
+    explicit block_buffer(const Allocator& alloc) noexcept
+        : allocator_(alloc)
+    {
+    }
+
+    block_buffer(const block_buffer& other)
+        : block_buffer(other,
+                       traits::select_on_container_copy_construction(
+                           other.allocator_))
+    {
+    }
+
+    block_buffer(const block_buffer& other, const Allocator& alloc)
+        : allocator_(alloc)
+    {
+        assign(other);
+    }
+
+    block_buffer(block_buffer&& other) noexcept
+        : allocator_(std::move(other.allocator_))
+    {
+        steal(other);
+    }
+
+    block_buffer(block_buffer&& other, const Allocator& alloc)
+        : allocator_(alloc)
+    {
+        if(allocator_ == other.allocator_)
+            steal(other);
+        else
+            assign(other);
+    }
+
+    block_buffer& operator=(const block_buffer& other)
+    {
+        if(this == &other)
+            return *this;
+
+        if constexpr(traits::propagate_on_container_copy_assignment::value)
+        {
+            if(allocator_ != other.allocator_)
+                release();
+            allocator_ = other.allocator_;
+        }
+
+        assign(other);
+        return *this;
+    }
+
+    block_buffer& operator=(block_buffer&& other) noexcept(
+        traits::propagate_on_container_move_assignment::value ||
+        traits::is_always_equal::value)
+    {
+        if(this == &other)
+            return *this;
+
+        if constexpr(traits::propagate_on_container_move_assignment::value)
+        {
+            release();
+            allocator_ = std::move(other.allocator_);
+            steal(other);
+        }
+        else
+        {
+            // Memory from another allocator can't be adopted, we copy the
+            // blocks instead
+            if(allocator_ == other.allocator_)
+            {
+                release();
+                steal(other);
+            }
+            else
+            {
+                assign(other);
+            }
+        }
+        return *this;
+    }
+
+    ~block_buffer() { release(); }
+
+    allocator_type get_allocator() const noexcept { return allocator_; }
+
+    /**
+     * @brief   Returns true if the blocks are stored inside the object
+     */
+    bool is_inline() const noexcept { return capacity_ == inline_capacity; }
+
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    Block* data() noexcept
+    {
+        return is_inline() ? inline_ : std::to_address(heap_);
+    }
+
+    const Block* data() const noexcept
+    {
+        return is_inline() ? inline_ : std::to_address(heap_);
+    }
+
+    Block&       operator[](std::size_t i) noexcept { return data()[i]; }
+    const Block& operator[](std::size_t i) const noexcept
+    {
+        return data()[i];
+    }
+
+    /**
+     * @brief   Resizes the buffer to @p count blocks. New blocks are equal to
+     *          @p value
+     */
+    void resize(std::size_t count, Block value = 0)
+    {
+        if(count > capacity_)
+        {
+            // Grows geometrically so push_back like usages stay amortized
+            const auto grown =
+                capacity_ > max_size() / 2 ? max_size() : capacity_ * 2;
+            reserve(std::max(count, grown));
+        }
+
+        if(count > size_)
+            std::fill(data() + size_, data() + count, value);
+
+        size_ = count;
+    }
+
+    /**
+     * @brief   Makes sure the buffer can hold @p count blocks without
+     *          reallocating
+     */
+    void reserve(std::size_t count)
+    {
+        if(count <= capacity_)
+            return;
+
+        if(count > max_size())
+            raise<std::length_error>(
+                "Block count is greater than buffer limit");
+
+        reallocate(count);
+    }
+
+    /**
+     * @brief   Maximum number of blocks the buffer can hold
+     */
+    static constexpr std::size_t max_size() noexcept
+    {
+        return static_cast<std::size_t>(
+                   std::numeric_limits<std::ptrdiff_t>::max()) /
+               sizeof(Block);
+    }
+
+private:
+    /**
+     * @brief   Moves the blocks to a new heap array of @p capacity blocks
+     */
+    void reallocate(std::size_t capacity)
+    {
+        pointer blocks = traits::allocate(allocator_, capacity);
+
+        std::memcpy(std::to_address(blocks), data(), size_ * sizeof(Block));
+
+        record(counter::reallocations);
+        record(counter::bytes_allocated, capacity * sizeof(Block));
+        record(counter::bytes_copied, size_ * sizeof(Block));
+
+        if(!is_inline())
+            traits::deallocate(allocator_, heap_, capacity_);
+
+        heap_     = blocks;
+        capacity_ = capacity;
+    }
+
+    /**
+     * @brief   Copies the blocks of @p other, reusing our memory if it's big
+     *          enough
+     */
+    void assign(const block_buffer& other)
+    {
+        size_ = 0;
+        reserve(other.size_);
+        std::memcpy(data(), other.data(), other.size_ * sizeof(Block));
+        size_ = other.size_;
+
+        record(counter::bytes_copied, other.size_ * sizeof(Block));
+    }
+
+    /**
+     * @brief   Takes the blocks of @p other and leaves it empty. Our memory
+     *          must have been released and allocators must be equal
+     */
+    void steal(block_buffer& other) noexcept
+    {
+        if(other.is_inline())
+        {
+            std::copy(other.inline_, other.inline_ + inline_capacity,
+                      inline_);
+        }
+        else
+        {
+            heap_           = other.heap_;
+            capacity_       = other.capacity_;
+            other.heap_     = pointer();
+            other.capacity_ = inline_capacity;
+        }
+
+        size_       = other.size_;
+        other.size_ = 0;
+    }
+
+    void release() noexcept
+    {
+        if(!is_inline())
+        {
+            traits::deallocate(allocator_, heap_, capacity_);
+            heap_     = pointer();
+            capacity_ = inline_capacity;
+        }
+        size_ = 0;
+    }
+
+    [[no_unique_address]] Allocator allocator_ {};
+
+    pointer     heap_ {};
+    std::size_t size_ {0};
+    std::size_t capacity_ {inline_capacity};
+    Block       inline_[inline_capacity] {};
+};
+
+}    // namespace corgi::binary::detail
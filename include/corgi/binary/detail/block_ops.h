@@ -0,0 +1,479 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+/**
+ * Kernels working on arrays of blocks.
+ *
+ * The non template overloads take 64 bits blocks and are dispatched at
+ * runtime to the best implementation the CPU supports (see simd.h). Overload
+ * resolution picks them over the generic templates, which are only used for
+ * the other block types.
+ *
+ * For the binary operations, @p dst can be the same array as @p a, but the
+ * arrays must not partially overlap.
+ */
+namespace corgi::binary::detail
+{
+/**
+ * @brief   dst[i] = a[i] & b[i] for i in [0, count)
+ */
+void and_blocks(std::uint64_t*       dst,
+                const std::uint64_t* a,
+                const std::uint64_t* b,
+                std::size_t          count) noexcept;
+
+/**
+ * @brief   dst[i] = a[i] | b[i] for i in [0, count)
+ */
+void or_blocks(std::uint64_t*       dst,
+               const std::uint64_t* a,
+               const std::uint64_t* b,
+               std::size_t          count) noexcept;
+
+/**
+ * @brief   dst[i] = a[i] ^ b[i] for i in [0, count)
+ */
+void xor_blocks(std::uint64_t*       dst,
+                const std::uint64_t* a,
+                const std::uint64_t* b,
+                std::size_t          count) noexcept;
+
+/**
+ * @brief   dst[i] = a[i] & ~b[i] for i in [0, count)
+ */
+void andnot_blocks(std::uint64_t*       dst,
+                   const std::uint64_t* a,
+                   const std::uint64_t* b,
+                   std::size_t          count) noexcept;
+
+/**
+ * @brief   dst[i] = ~a[i] for i in [0, count)
+ */
+void not_blocks(std::uint64_t*       dst,
+                const std::uint64_t* a,
+                std::size_t          count) noexcept;
+
+/**
+ * @brief   Returns the number of bits set in the @p count first blocks of
+ *          @p blocks
+ */
+std::size_t count_blocks(const std::uint64_t* blocks,
+                         std::size_t          count) noexcept;
+
+/**
+ * @brief   Returns the index of the first block that isn't 0 in
+ *          [@p first, @p last), or @p last if they are all 0
+ */
+std::size_t find_nonzero_block(const std::uint64_t* blocks,
+                               std::size_t          first,
+                               std::size_t          last) noexcept;
+
+/**
+ * @brief   Returns the index of the last block that isn't 0 in
+ *          [@p first, @p last), or @p last if they are all 0
+ */
+std::size_t rfind_nonzero_block(const std::uint64_t* blocks,
+                                std::size_t          first,
+                                std::size_t          last) noexcept;
+
+/**
+ * @brief   Number of bits stored in a single @p Block
+ */
+template<class Block>
+inline constexpr std::size_t block_bits = std::numeric_limits<Block>::digits;
+
+/**
+ * @brief   Returns a block where only the @p bit_count first bits are set
+ */
+template<class Block>
+constexpr Block low_mask(std::size_t bit_count) noexcept
+{
+    return bit_count >= block_bits<Block>
+               ? static_cast<Block>(~Block {0})
+               : static_cast<Block>((Block {1} << bit_count) - 1);
+}
+
+/**
+ * @brief   Computes the minimum number of @p Block needed to store
+ *          @p bit_count bits
+ */
+template<class Block>
+constexpr std::size_t block_count(std::size_t bit_count) noexcept
+{
+    return bit_count / block_bits<Block> +
+           (bit_count % block_bits<Block> != 0);
+}
+
+/**
+ * @brief   Computes the minimum number of bytes needed to store @p bit_count
+ *          bits
+ */
+constexpr std::size_t byte_count(std::size_t bit_count) noexcept
+{
+    return bit_count / 8 + (bit_count % 8 != 0);
+}
+
+template<class Block>
+void and_blocks(Block*       dst,
+                const Block* a,
+                const Block* b,
+                std::size_t  count) noexcept
+{
+    for(std::size_t i = 0; i < count; i++)
+        dst[i] = a[i] & b[i];
+}
+
+template<class Block>
+void or_blocks(Block*       dst,
+               const Block* a,
+               const Block* b,
+               std::size_t  count) noexcept
+{
+    for(std::size_t i = 0; i < count; i++)
+        dst[i] = a[i] | b[i];
+}
+
+template<class Block>
+void xor_blocks(Block*       dst,
+                const Block* a,
+                const Block* b,
+                std::size_t  count) noexcept
+{
+    for(std::size_t i = 0; i < count; i++)
+        dst[i] = a[i] ^ b[i];
+}
+
+template<class Block>
+void andnot_blocks(Block*       dst,
+                   const Block* a,
+                   const Block* b,
+                   std::size_t  count) noexcept
+{
+    for(std::size_t i = 0; i < count; i++)
+        dst[i] = a[i] & static_cast<Block>(~b[i]);
+}
+
+template<class Block>
+void not_blocks(Block* dst, const Block* a, std::size_t count) noexcept
+{
+    for(std::size_t i = 0; i < count; i++)
+        dst[i] = static_cast<Block>(~a[i]);
+}
+
+template<class Block>
+std::size_t count_blocks(const Block* blocks, std::size_t count) noexcept
+{
+    std::size_t result = 0;
+    for(std::size_t i = 0; i < count; i++)
+        result += static_cast<std::size_t>(std::popcount(blocks[i]));
+    return result;
+}
+
+template<class Block>
+std::size_t find_nonzero_block(const Block* blocks,
+                               std::size_t  first,
+                               std::size_t  last) noexcept
+{
+    for(auto i = first; i < last; i++)
+    {
+        if(blocks[i] != 0)
+            return i;
+    }
+    return last;
+}
+
+template<class Block>
+std::size_t rfind_nonzero_block(const Block* blocks,
+                                std::size_t  first,
+                                std::size_t  last) noexcept
+{
+    for(auto i = last; i-- > first;)
+    {
+        if(blocks[i] != 0)
+            return i;
+    }
+    return last;
+}
+
+/**
+ * @brief   Reads @p len (<= block_bits) bits located at @p pos, funneling
+ *          them from 2 blocks when they straddle a block boundary
+ */
+template<class Block>
+Block read_bits(const Block* src, std::size_t pos, std::size_t len) noexcept
+{
+    constexpr auto bits   = block_bits<Block>;
+    const auto     index  = pos / bits;
+    const auto     offset = pos % bits;
+
+    Block value = static_cast<Block>(src[index] >> offset);
+    if(offset + len > bits)
+        value |= static_cast<Block>(src[index + 1] << (bits - offset));
+
+    return value & low_mask<Block>(len);
+}
+
+/**
+ * @brief   Writes the @p len low bits of @p value at @p pos. The bits must all
+ *          land in the same block
+ */
+template<class Block>
+void write_bits(Block*      dst,
+                std::size_t pos,
+                std::size_t len,
+                Block       value) noexcept
+{
+    constexpr auto bits   = block_bits<Block>;
+    const auto     index  = pos / bits;
+    const auto     offset = pos % bits;
+    const auto mask = static_cast<Block>(low_mask<Block>(len) << offset);
+
+    dst[index] = static_cast<Block>(
+        (dst[index] & ~mask) | (static_cast<Block>(value << offset) & mask));
+}
+
+/**
+ * @brief   Copies @p len bits one destination block at a time
+ *
+ * Going forward is safe when the destination is before the source, and
+ * backward when it's after : a block is always read before being
+ * overwritten.
+ */
+template<class Block>
+void copy_bits_unaligned(Block*       dst,
+                         std::size_t  dst_pos,
+                         const Block* src,
+                         std::size_t  src_pos,
+                         std::size_t  len) noexcept
+{
+    constexpr auto bits = block_bits<Block>;
+
+    if(dst_pos <= src_pos)
+    {
+        while(len > 0)
+        {
+            const auto n = std::min(bits - dst_pos % bits, len);
+            write_bits(dst, dst_pos, n, read_bits(src, src_pos, n));
+            dst_pos += n;
+            src_pos += n;
+            len -= n;
+        }
+        return;
+    }
+
+    while(len > 0)
+    {
+        const auto end   = dst_pos + len;
+        const auto first = std::max((end - 1) / bits * bits, dst_pos);
+        const auto n     = end - first;
+        write_bits(dst, first, n, read_bits(src, src_pos + len - n, n));
+        len -= n;
+    }
+}
+
+/**
+ * @brief   Copies @p len bits located at bit @p src_pos in @p src to bit
+ *          @p dst_pos in @p dst
+ *
+ * Works like memmove : @p dst and @p src can be the same array and the
+ * ranges can overlap. Bits of @p dst outside the destination range are left
+ * untouched.
+ */
+template<class Block>
+void copy_bits(Block*       dst,
+               std::size_t  dst_pos,
+               const Block* src,
+               std::size_t  src_pos,
+               std::size_t  len) noexcept
+{
+    if(len == 0 || (dst == src && dst_pos == src_pos))
+        return;
+
+    // When both positions share the same offset inside a byte, everything but
+    // the edges can be moved with a memmove. This relies on the blocks being
+    // laid out as little endian bytes.
+    if(dst_pos % 8 != src_pos % 8 || len < 2 * block_bits<Block>)
+    {
+        copy_bits_unaligned(dst, dst_pos, src, src_pos, len);
+        return;
+    }
+
+    const auto head  = (8 - dst_pos % 8) % 8;
+    const auto bytes = (len - head) / 8;
+    const auto tail  = len - head - bytes * 8;
+
+    auto copy_head = [&]()
+    { copy_bits_unaligned(dst, dst_pos, src, src_pos, head); };
+
+    auto copy_tail = [&]()
+    {
+        copy_bits_unaligned(dst, dst_pos + head + bytes * 8, src,
+                            src_pos + head + bytes * 8, tail);
+    };
+
+    auto copy_middle = [&]()
+    {
+        std::memmove(reinterpret_cast<unsigned char*>(dst) +
+                         (dst_pos + head) / 8,
+                     reinterpret_cast<const unsigned char*>(src) +
+                         (src_pos + head) / 8,
+                     bytes);
+    };
+
+    // The order matters when the ranges overlap, the edge that could be
+    // overwritten by the memmove is copied last
+    if(dst_pos < src_pos)
+    {
+        copy_head();
+        copy_middle();
+        copy_tail();
+    }
+    else
+    {
+        copy_tail();
+        copy_middle();
+        copy_head();
+    }
+}
+
+/**
+ * @brief   Sets the bits in [@p first, @p last) to @p value
+ */
+template<class Block>
+void fill_bits(Block*      blocks,
+               std::size_t first,
+               std::size_t last,
+               bool        value) noexcept
+{
+    if(first >= last)
+        return;
+
+    constexpr auto bits        = block_bits<Block>;
+    const auto     first_block = first / bits;
+    const auto     last_block  = (last - 1) / bits;
+
+    const auto first_mask = static_cast<Block>(~low_mask<Block>(first % bits));
+    const auto last_mask  = low_mask<Block>(last - last_block * bits);
+
+    auto apply = [value, blocks](std::size_t index, Block mask)
+    {
+        if(value)
+            blocks[index] |= mask;
+        else
+            blocks[index] &= static_cast<Block>(~mask);
+    };
+
+    if(first_block == last_block)
+    {
+        apply(first_block, first_mask & last_mask);
+        return;
+    }
+
+    apply(first_block, first_mask);
+    std::fill(blocks + first_block + 1, blocks + last_block,
+              value ? static_cast<Block>(~Block {0}) : Block {0});
+    apply(last_block, last_mask);
+}
+
+/**
+ * @brief   Returns the position of the first run of @p length bits equal to
+ *          @p value in [@p from, @p bit_size), or bit_size if there's none
+ *
+ * Blocks without matching bits are skipped and full blocks extend the run
+ * reaching the end of the previous block. The runs held inside a block are
+ * found by and-ing the block with itself shifted, which takes log2(length)
+ * steps.
+ */
+template<class Block>
+std::size_t find_run(const Block* blocks,
+                     std::size_t  bit_size,
+                     bool         value,
+                     std::size_t  length,
+                     std::size_t  from) noexcept
+{
+    if(from > bit_size || length > bit_size - from)
+        return bit_size;
+
+    if(length == 0)
+        return from;
+
+    constexpr auto bits = block_bits<Block>;
+    constexpr auto full = static_cast<Block>(~Block {0});
+
+    // Blocks without matching bits, skipped a block at a time
+    const auto skip = value ? Block {0} : full;
+
+    const auto first_block = from / bits;
+    const auto last_block  = (bit_size - 1) / bits;
+
+    // Run of matching bits reaching the end of the previous block
+    std::size_t run_start  = 0;
+    std::size_t run_length = 0;
+
+    for(auto index = first_block; index <= last_block; index++)
+    {
+        // Matching bits are 1, the ones outside [from, bit_size) are 0
+        auto block = static_cast<Block>(blocks[index] ^ skip);
+        if(index == first_block)
+            block &= static_cast<Block>(~low_mask<Block>(from % bits));
+        if(index == last_block)
+            block &= low_mask<Block>(bit_size - index * bits);
+
+        const auto base = index * bits;
+
+        if(block == 0)
+        {
+            run_length = 0;
+            while(index + 1 < last_block && blocks[index + 1] == skip)
+                index++;
+            continue;
+        }
+
+        if(block == full)
+        {
+            if(run_length == 0)
+                run_start = base;
+            run_length += bits;
+            if(run_length >= length)
+                return run_start;
+            continue;
+        }
+
+        // The bits at the start of the block extend the previous run
+        if(run_length != 0 && (block & 1) != 0 &&
+           run_length + static_cast<std::size_t>(std::countr_one(block)) >=
+               length)
+            return run_start;
+
+        if(length <= bits)
+        {
+            // Bit i of starts is set if the bits [i, i + covered) are
+            auto        starts  = block;
+            std::size_t covered = 1;
+            while(covered < length)
+            {
+                const auto shift = std::min(covered, length - covered);
+                starts &= static_cast<Block>(starts >> shift);
+                covered += shift;
+            }
+
+            if(starts != 0)
+                return base +
+                       static_cast<std::size_t>(std::countr_zero(starts));
+        }
+
+        run_length = (block >> (bits - 1)) != 0
+                         ? static_cast<std::size_t>(std::countl_one(block))
+                         : 0;
+        run_start  = base + bits - run_length;
+    }
+    return bit_size;
+}
+
+}    // namespace corgi::binary::detail
@@ -0,0 +1,781 @@
+#pragma once
+
+// Definitions of the basic_dynamic_bitset members. Included at the end of
+// dynamic_bitset.h, don't include this file directly.
+
+namespace corgi::binary
+{
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::any() const noexcept
+{
+    const auto count = block_size();
+    detail::record(detail::counter::word_operations, count);
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        if(blocks_[i] != 0)
+            return true;
+    }
+    return false;
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::reallocate(const std::size_t len)
+{
+    const auto blocks = detail::block_count<Block>(len);
+    if(blocks > blocks_.size())
+        blocks_.resize(blocks, 0);
+
+    byte_size_ = std::max(byte_size_, detail::byte_count(len));
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::mask_last_block() noexcept
+{
+    const auto used = bit_size_ % bits_per_block;
+    if(used != 0)
+        blocks_[bit_size_ / bits_per_block] &= detail::low_mask<Block>(used);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::shrink_to(
+    std::size_t len) noexcept
+{
+    const auto previous_blocks = block_size();
+    bit_size_                  = len;
+    mask_last_block();
+    std::fill(blocks_.data() + block_size(),
+              blocks_.data() + previous_blocks, Block {0});
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::insert(
+    const std::size_t                 pos,
+    const std::initializer_list<bool> bits)
+{
+    if(pos > bit_size_)
+        detail::raise<std::out_of_range>(
+            "Argument pos is equal is out of range");
+
+    make_room(pos, bits.size());
+
+    // Bits are packed into a block before being written, so we only touch
+    // the storage once every 64 bits
+    auto        it     = bits.begin();
+    std::size_t offset = 0;
+    while(offset < bits.size())
+    {
+        const auto n = std::min(bits_per_block, bits.size() - offset);
+
+        block_type block = 0;
+        for(std::size_t i = 0; i < n; i++)
+            block |= static_cast<block_type>(*it++) << i;
+
+        detail::copy_bits(blocks(), pos + offset, &block, 0, n);
+        offset += n;
+    }
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::insert(std::size_t pos,
+                                                    std::size_t len,
+                                                    bool        val)
+{
+    if(pos > bit_size_)
+        detail::raise<std::out_of_range>("Argument pos is out of range ");
+
+    make_room(pos, len);
+    detail::fill_bits(blocks(), pos, pos + len, val);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::insert(std::size_t pos, bool val)
+{
+    insert(pos, 1, val);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::make_room(std::size_t pos,
+                                                       std::size_t len)
+{
+    if(len > max_size() - bit_size_)
+        detail::raise<std::length_error>(
+            "Bit count is greater than bitset limit");
+
+    const auto previous_size = bit_size_;
+
+    reallocate(bit_size_ + len);
+    bit_size_ += len;
+
+    detail::copy_bits(blocks(), pos + len, blocks(), pos,
+                      previous_size - pos);
+    detail::record(detail::counter::bytes_copied,
+                   detail::byte_count(previous_size - pos));
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::erase(const std::size_t pos)
+{
+    if(!in_range(pos))
+        detail::raise<std::out_of_range>("Argument pos is out of range");
+
+    detail::copy_bits(blocks(), pos, blocks(), pos + 1, bit_size_ - pos - 1);
+    detail::record(detail::counter::bytes_copied,
+                   detail::byte_count(bit_size_ - pos - 1));
+    shrink_to(bit_size_ - 1);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::erase(const std::size_t start,
+                                                   const std::size_t end)
+{
+    if(!in_range(start))
+        detail::raise<std::out_of_range>("Argument start is out of range ");
+
+    if(!in_range(end))
+        detail::raise<std::out_of_range>("Argument end is out of range ");
+
+    if(start > end)
+        detail::raise<std::invalid_argument>(
+            "Argument start is greater than argument end");
+
+    detail::copy_bits(blocks(), start, blocks(), end + 1, bit_size_ - end - 1);
+    detail::record(detail::counter::bytes_copied,
+                   detail::byte_count(bit_size_ - end - 1));
+    shrink_to(bit_size_ - (end - start + 1));
+}
+
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::operator==(
+    const basic_dynamic_bitset& other) const noexcept
+{
+    if(other.size() != size())
+        return false;
+
+    detail::record(detail::counter::word_operations, block_size());
+
+    // Bits past size() are always 0 so we can compare whole blocks
+    return std::equal(blocks_.data(), blocks_.data() + block_size(),
+                      other.blocks_.data());
+}
+
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::all() const noexcept
+{
+    if(empty())
+        return true;
+
+    detail::record(detail::counter::word_operations, block_size());
+
+    const auto full_blocks = bit_size_ / bits_per_block;
+
+    for(std::size_t i = 0; i < full_blocks; i++)
+    {
+        if(blocks_[i] != block_all_set)
+            return false;
+    }
+
+    const auto remaining = bit_size_ % bits_per_block;
+
+    return remaining == 0 ||
+           blocks_[full_blocks] == detail::low_mask<Block>(remaining);
+}
+
+template<class Block, class Allocator>
+std::size_t basic_dynamic_bitset<Block, Allocator>::count() const noexcept
+{
+    detail::record(detail::counter::word_operations, block_size());
+    return detail::count_blocks(blocks(), block_size());
+}
+
+template<class Block, class Allocator>
+std::size_t
+basic_dynamic_bitset<Block, Allocator>::count(std::size_t first,
+                                              std::size_t last) const
+{
+    if(last > bit_size_)
+        detail::raise<std::out_of_range>("Argument last is out of range");
+
+    if(first > last)
+        detail::raise<std::invalid_argument>(
+            "Argument first is greater than argument last");
+
+    if(first == last)
+        return 0;
+
+    const auto first_block = first / bits_per_block;
+    const auto last_block  = (last - 1) / bits_per_block;
+
+    // Only keeps the bits of the range in the first and last blocks
+    const auto first_mask =
+        static_cast<Block>(~detail::low_mask<Block>(first % bits_per_block));
+    const auto last_mask =
+        detail::low_mask<Block>(last - last_block * bits_per_block);
+
+    auto count_masked = [this](std::size_t index, Block mask)
+    {
+        return static_cast<std::size_t>(
+            std::popcount(static_cast<Block>(blocks_[index] & mask)));
+    };
+
+    if(first_block == last_block)
+        return count_masked(first_block,
+                            static_cast<Block>(first_mask & last_mask));
+
+    return count_masked(first_block, first_mask) +
+           detail::count_blocks(blocks() + first_block + 1,
+                                last_block - first_block - 1) +
+           count_masked(last_block, last_mask);
+}
+
+template<class Block, class Allocator>
+std::size_t
+basic_dynamic_bitset<Block, Allocator>::find_first() const noexcept
+{
+    return find_next(npos);
+}
+
+template<class Block, class Allocator>
+std::size_t basic_dynamic_bitset<Block, Allocator>::find_next(
+    std::size_t pos) const noexcept
+{
+    // npos + 1 wraps around to 0, which lets find_first reuse this function
+    const auto first = pos + 1;
+    if(first >= bit_size_)
+        return npos;
+
+    auto       block_index = first / bits_per_block;
+    const Block block      = static_cast<Block>(
+        blocks_[block_index] &
+        ~detail::low_mask<Block>(first % bits_per_block));
+
+    if(block != 0)
+        return block_index * bits_per_block +
+               static_cast<std::size_t>(std::countr_zero(block));
+
+    const auto count = block_size();
+    block_index = detail::find_nonzero_block(blocks(), block_index + 1, count);
+
+    if(block_index == count)
+        return npos;
+
+    return block_index * bits_per_block +
+           static_cast<std::size_t>(std::countr_zero(blocks_[block_index]));
+}
+
+template<class Block, class Allocator>
+std::size_t
+basic_dynamic_bitset<Block, Allocator>::find_last() const noexcept
+{
+    return find_prev(bit_size_);
+}
+
+template<class Block, class Allocator>
+std::size_t basic_dynamic_bitset<Block, Allocator>::find_prev(
+    std::size_t pos) const noexcept
+{
+    // Looks at the bits in [0, last]
+    if(pos == 0 || bit_size_ == 0)
+        return npos;
+
+    const auto last = std::min(pos, bit_size_) - 1;
+
+    auto       block_index = last / bits_per_block;
+    const Block block      = static_cast<Block>(
+        blocks_[block_index] &
+        detail::low_mask<Block>(last % bits_per_block + 1));
+
+    if(block != 0)
+        return block_index * bits_per_block + bits_per_block - 1 -
+               static_cast<std::size_t>(std::countl_zero(block));
+
+    block_index = detail::rfind_nonzero_block(blocks(), 0, block_index);
+
+    if(block_index == last / bits_per_block)
+        return npos;
+
+    return block_index * bits_per_block + bits_per_block - 1 -
+           static_cast<std::size_t>(std::countl_zero(blocks_[block_index]));
+}
+
+template<class Block, class Allocator>
+std::size_t basic_dynamic_bitset<Block, Allocator>::find_first_run(
+    bool        value,
+    std::size_t length,
+    std::size_t from) const noexcept
+{
+    // An empty run is found anywhere, bit_size_ included
+    if(length == 0)
+        return from <= bit_size_ ? from : npos;
+
+    const auto pos =
+        detail::find_run(blocks(), bit_size_, value, length, from);
+    return pos == bit_size_ ? npos : pos;
+}
+
+template<class Block, class Allocator>
+set_bit_range<Block>
+basic_dynamic_bitset<Block, Allocator>::set_bits() const noexcept
+{
+    return set_bit_range<Block>(blocks(), block_size());
+}
+
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::none() const noexcept
+{
+    return !any();
+}
+
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::empty() const noexcept
+{
+    return bit_size_ == 0;
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::push_back(bool value)
+{
+    reallocate(bit_size_ + 1);
+
+    bit_size_++;
+    set(bit_size_ - 1, value);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::pop_back()
+{
+    if(bit_size_ != 0)
+        shrink_to(bit_size_ - 1);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::resize(std::size_t len,
+                                                    bool        value)
+{
+    if(len == bit_size_)
+        return;
+
+    if(len > max_size())
+        detail::raise<std::length_error>(
+            "Bit count is greater than bitset limit");
+
+    if(len < bit_size_)
+    {
+        shrink_to(len);
+        return;
+    }
+
+    const auto previous_size = bit_size_;
+    reallocate(len);
+    bit_size_ = len;
+
+    if(!value)
+        return;
+
+    // Fills the end of the block the previous last bit lived in, then whole
+    // blocks
+    auto first_block = previous_size / bits_per_block;
+    if(previous_size % bits_per_block != 0)
+        blocks_[first_block++] |= static_cast<Block>(
+            ~detail::low_mask<Block>(previous_size % bits_per_block));
+
+    std::fill(blocks_.data() + first_block, blocks_.data() + block_size(),
+              block_all_set);
+    mask_last_block();
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::reserve(std::size_t len)
+{
+    blocks_.reserve(detail::block_count<Block>(len));
+}
+
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::in_range(
+    std::size_t bit_index) const
+{
+    return (bit_index < bit_size_);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::set(bool value)
+{
+    detail::record(detail::counter::word_operations, block_size());
+    std::fill(blocks_.data(), blocks_.data() + block_size(),
+              value ? block_all_set : Block {0});
+    mask_last_block();
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::check_slice(std::size_t start,
+                                                         std::size_t end) const
+{
+    if(!in_range(start))
+        detail::raise<std::out_of_range>("Argument start is out of range");
+
+    if(!in_range(end))
+        detail::raise<std::out_of_range>("Argument end is out of range");
+
+    if(start > end)
+        detail::raise<std::invalid_argument>(
+            "Argument start is greater than argument end");
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>
+basic_dynamic_bitset<Block, Allocator>::slice(std::size_t start,
+                                              std::size_t end) const
+{
+    const auto view = slice_view(start, end);
+
+    // The view reads 64 bits at a time whatever the alignment of start
+    basic_dynamic_bitset bs(view.size(), false, get_allocator());
+    view.copy_to(bs.data());
+
+    detail::record(detail::counter::slices);
+    detail::record(detail::counter::bytes_copied,
+                   detail::byte_count(view.size()));
+    return bs;
+}
+
+template<class Block, class Allocator>
+bit_span basic_dynamic_bitset<Block, Allocator>::slice_view(std::size_t start,
+                                                            std::size_t end)
+{
+    check_slice(start, end);
+    return bit_span(data(), end - start + 1, start);
+}
+
+template<class Block, class Allocator>
+const_bit_span
+basic_dynamic_bitset<Block, Allocator>::slice_view(std::size_t start,
+                                                   std::size_t end) const
+{
+    check_slice(start, end);
+    return const_bit_span(data(), end - start + 1, start);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::set(std::size_t pos, bool value)
+{
+    if(!in_range(pos))
+        detail::raise<std::out_of_range>("Argument pos is out of range");
+
+    set_unchecked(pos, value);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::flip(std::size_t pos)
+{
+    if(!in_range(pos))
+        detail::raise<std::out_of_range>("Argument pos is out of range");
+
+    detail::record(detail::counter::bit_operations);
+    blocks_[pos / bits_per_block] ^=
+        static_cast<Block>(block_type {1} << (pos % bits_per_block));
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::flip()
+{
+    const auto count = block_size();
+    detail::record(detail::counter::word_operations, count);
+    for(std::size_t i = 0; i < count; i++)
+        blocks_[i] = static_cast<Block>(~blocks_[i]);
+    mask_last_block();
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::reset(std::size_t pos)
+{
+    if(!in_range(pos))
+        detail::raise<std::out_of_range>("Argument pos is out of range");
+
+    set_unchecked(pos, false);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::reset()
+{
+    detail::record(detail::counter::word_operations, block_size());
+    std::fill(blocks_.data(), blocks_.data() + block_size(), Block {0});
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::set_range(std::size_t first,
+                                                       std::size_t last,
+                                                       bool        value)
+{
+    if(last > bit_size_)
+        detail::raise<std::out_of_range>("Argument last is out of range");
+
+    if(first > last)
+        detail::raise<std::invalid_argument>(
+            "Argument first is greater than argument last");
+
+    detail::fill_bits(blocks(), first, last, value);
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::reset_range(std::size_t first,
+                                                         std::size_t last)
+{
+    set_range(first, last, false);
+}
+
+template<class Block, class Allocator>
+std::size_t
+basic_dynamic_bitset<Block, Allocator>::claim_run(std::size_t length,
+                                                  std::size_t from)
+{
+    const auto pos = find_first_run(false, length, from);
+    if(pos != npos)
+        detail::fill_bits(blocks(), pos, pos + length, true);
+    return pos;
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::check_same_size(
+    const basic_dynamic_bitset& other) const
+{
+    if(other.size() != size())
+        detail::raise<std::invalid_argument>(
+            "Argument other doesn't have the same size as the bitset");
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>&
+basic_dynamic_bitset<Block, Allocator>::operator&=(
+    const basic_dynamic_bitset& other)
+{
+    check_same_size(other);
+    detail::record(detail::counter::word_operations, block_size());
+    detail::and_blocks(blocks(), blocks(), other.blocks(), block_size());
+    return *this;
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>&
+basic_dynamic_bitset<Block, Allocator>::operator|=(
+    const basic_dynamic_bitset& other)
+{
+    check_same_size(other);
+    detail::record(detail::counter::word_operations, block_size());
+    detail::or_blocks(blocks(), blocks(), other.blocks(), block_size());
+    return *this;
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>&
+basic_dynamic_bitset<Block, Allocator>::operator^=(
+    const basic_dynamic_bitset& other)
+{
+    check_same_size(other);
+    detail::record(detail::counter::word_operations, block_size());
+    detail::xor_blocks(blocks(), blocks(), other.blocks(), block_size());
+    return *this;
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>&
+basic_dynamic_bitset<Block, Allocator>::operator-=(
+    const basic_dynamic_bitset& other)
+{
+    check_same_size(other);
+    detail::record(detail::counter::word_operations, block_size());
+    detail::andnot_blocks(blocks(), blocks(), other.blocks(), block_size());
+    return *this;
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>
+basic_dynamic_bitset<Block, Allocator>::operator~() const
+{
+    basic_dynamic_bitset result(size(), false, get_allocator());
+    detail::record(detail::counter::word_operations, block_size());
+    detail::not_blocks(result.blocks(), blocks(), block_size());
+    result.mask_last_block();
+    return result;
+}
+
+template<class Block, class Allocator>
+unsigned long long basic_dynamic_bitset<Block, Allocator>::to_ullong()
+    const
+{
+    if(bit_size_ > (sizeof(unsigned long long) * 8))
+    {
+        detail::raise<std::overflow_error>(
+            "dynamic_bitset : Too much bits in bitset to convert to an "
+            "unsigned long long");
+    }
+
+    // Bits past size() are 0, so copying the bytes of the first blocks gives
+    // the value whatever the block type
+    unsigned long long value = 0;
+    std::memcpy(&value, data(), detail::byte_count(bit_size_));
+    return value;
+}
+
+template<class Block, class Allocator>
+unsigned long long
+basic_dynamic_bitset<Block, Allocator>::to_ullong(std::size_t pos,
+                                                  std::size_t len)
+{
+    return bits_to_llong(pos, len, data(), byte_size());
+}
+
+template<class Block, class Allocator>
+void basic_dynamic_bitset<Block, Allocator>::clear()
+{
+    shrink_to(0);
+}
+
+template<class Block, class Allocator>
+std::size_t
+basic_dynamic_bitset<Block, Allocator>::byte_size() const noexcept
+{
+    return byte_size_;
+}
+
+template<class Block, class Allocator>
+std::size_t
+basic_dynamic_bitset<Block, Allocator>::block_size() const noexcept
+{
+    return detail::block_count<Block>(bit_size_);
+}
+
+template<class Block, class Allocator>
+Block* basic_dynamic_bitset<Block, Allocator>::blocks() noexcept
+{
+    return blocks_.data();
+}
+
+template<class Block, class Allocator>
+const Block* basic_dynamic_bitset<Block, Allocator>::blocks() const noexcept
+{
+    return blocks_.data();
+}
+
+template<class Block, class Allocator>
+unsigned char* basic_dynamic_bitset<Block, Allocator>::data()
+{
+    return reinterpret_cast<unsigned char*>(blocks_.data());
+}
+
+template<class Block, class Allocator>
+const unsigned char*
+basic_dynamic_bitset<Block, Allocator>::data() const
+{
+    return reinterpret_cast<const unsigned char*>(blocks_.data());
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>::basic_dynamic_bitset(
+    std::size_t      count,
+    bool             value,
+    const Allocator& alloc)
+    : blocks_(alloc)
+{
+    if(count > max_size())
+        detail::raise<std::length_error>(
+            "Bit count is greater than bitset limit");
+
+    reallocate(count);
+    bit_size_ = count;
+
+    if(value)
+        set(true);
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>::basic_dynamic_bitset(
+    std::initializer_list<bool> bits,
+    const Allocator&            alloc)
+    : blocks_(alloc)
+{
+    if(bits.size() > max_size())
+        detail::raise<std::length_error>(
+            "Initializer list count is greater than bitset limit");
+
+    reallocate(bits.size());
+    bit_size_ = bits.size();
+
+    std::size_t pos = 0;
+    for(const auto bit : bits)
+        set(pos++, bit);
+}
+
+template<class Block, class Allocator>
+std::size_t basic_dynamic_bitset<Block, Allocator>::size() const noexcept
+{
+    return bit_size_;
+}
+
+template<class Block, class Allocator>
+bool basic_dynamic_bitset<Block, Allocator>::test(std::size_t pos) const
+{
+    if(!in_range(pos))
+        detail::raise<std::out_of_range>("Argument pos is out of range ");
+
+    return test_unchecked(pos);
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>::basic_dynamic_bitset(
+    const Allocator& alloc) noexcept
+    : blocks_(alloc)
+{
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>::basic_dynamic_bitset(
+    const basic_dynamic_bitset& other,
+    const Allocator&            alloc)
+    : blocks_(other.blocks_, alloc)
+    , bit_size_(other.bit_size_)
+    , byte_size_(other.byte_size_)
+{
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>::basic_dynamic_bitset(
+    basic_dynamic_bitset&& other) noexcept
+    : blocks_(std::move(other.blocks_))
+    , bit_size_(std::exchange(other.bit_size_, 0))
+    , byte_size_(std::exchange(other.byte_size_, 0))
+{
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>&
+basic_dynamic_bitset<Block, Allocator>::operator=(basic_dynamic_bitset&& other)
+{
+    if(this == &other)
+        return *this;
+
+    blocks_    = std::move(other.blocks_);
+    bit_size_  = std::exchange(other.bit_size_, 0);
+    byte_size_ = std::exchange(other.byte_size_, 0);
+
+    // When the allocators differ the blocks were copied, other must still
+    // end up empty
+    other.blocks_.resize(0);
+    return *this;
+}
+
+template<class Block, class Allocator>
+Allocator basic_dynamic_bitset<Block, Allocator>::get_allocator() const noexcept
+{
+    return blocks_.get_allocator();
+}
+
+template<class Block, class Allocator>
+basic_dynamic_bitset<Block, Allocator>
+basic_dynamic_bitset<Block, Allocator>::make_result(
+    const basic_dynamic_bitset& other) const
+{
+    check_same_size(other);
+    return basic_dynamic_bitset(size(), false, get_allocator());
+}
+
+}    // namespace corgi::binary
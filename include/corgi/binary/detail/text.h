@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+
+/**
+ * Kernels converting packed bits to text and back.
+ *
+ * They work on the byte view of a bitset, bit i being stored in byte i / 8 at
+ * position i % 8. The binary format writes one character per bit, bit 0
+ * first. The hexadecimal format writes the bits as a number, the most
+ * significant digit first, so bit 0 is the lowest bit of the last digit.
+ */
+namespace corgi::binary::detail
+{
+/**
+ * @brief   Writes the first @p bit_count bits of @p bytes to @p out, @p zero
+ *          for the bits equal to 0 and @p one for the others
+ *
+ * @p out must hold @p bit_count characters.
+ */
+void bits_to_chars(const unsigned char* bytes,
+                   std::size_t          bit_count,
+                   char*                out,
+                   char                 zero,
+                   char                 one) noexcept;
+
+/**
+ * @brief   Packs the @p count characters of @p text into @p bytes
+ *
+ * Writes the (count + 7) / 8 first bytes of @p bytes, the bits past @p count
+ * being set to 0.
+ *
+ * @return  False if @p text holds something else than @p zero and @p one
+ */
+bool chars_to_bits(const char*    text,
+                   std::size_t    count,
+                   unsigned char* bytes,
+                   char           zero,
+                   char           one) noexcept;
+
+/**
+ * @brief   Writes the first @p bit_count bits of @p bytes as (bit_count + 3)
+ *          / 4 lower case hexadecimal digits
+ *
+ * The bits of the last byte located after @p bit_count must be 0.
+ */
+void bits_to_hex(const unsigned char* bytes,
+                 std::size_t          bit_count,
+                 char*                out) noexcept;
+
+/**
+ * @brief   Packs the @p count hexadecimal digits of @p text into @p bytes
+ *
+ * Writes the (count + 1) / 2 first bytes of @p bytes. Both cases are
+ * accepted.
+ *
+ * @return  False if @p text holds something else than hexadecimal digits
+ */
+bool hex_to_bits(const char* text, std::size_t count, unsigned char* bytes)
+    noexcept;
+
+/**
+ * @brief   Returns the value of the hexadecimal digit @p c, or -1 if it isn't
+ *          one
+ */
+int hex_digit_value(char c) noexcept;
+
+/**
+ * @brief   Writes the first @p bit_count bits of @p bytes to @p os as '0' and
+ *          '1', through a fixed size buffer
+ */
+void write_bits_text(std::ostream&        os,
+                     const unsigned char* bytes,
+                     std::size_t          bit_count);
+}    // namespace corgi::binary::detail
@@ -1,28 +1,139 @@
 #pragma once
 
+#include <corgi/binary/bit_span.h>
+#include <corgi/binary/detail/block_buffer.h>
+#include <corgi/binary/detail/block_ops.h>
+#include <corgi/binary/detail/text.h>
+#include <corgi/binary/set_bit_iterator.h>
+
+#include <corgi/binary/binary.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace corgi::binary
 {
 
+// data() exposes the blocks as an array of bytes, which only matches the
+// packing of the old byte storage on little endian machines
+static_assert(std::endian::native == std::endian::little,
+              "dynamic_bitset byte view requires a little endian target");
+
 /**
  * @brief   std::bitset but dynamic. Basically a container that stores
  *		    and manipulates bits.
  *
  *          Also this is totally inspired of boost dynamic_set but I just
  *          didn't want to pull boost only for that
+ *
+ *          Bits are packed inside @p Block so bulk operations can work
+ *          a whole block at a time. Bits located after size() inside the last
+ *          block are always kept to 0. Up to 128 bits are stored inside the
+ *          object, so small bitsets don't allocate. Larger bitsets get their
+ *          memory from @p Allocator.
+ *
+ *          The SIMD kernels are used when @p Block is std::uint64_t, other
+ *          block types go through portable loops.
+ *
+ * @tparam Block        Unsigned integer type the bits are packed into
+ * @tparam Allocator    Allocator of @p Block
  */
-class dynamic_bitset
+template<class Block = std::uint64_t, class Allocator = std::allocator<Block>>
+class basic_dynamic_bitset
 {
+    static_assert(std::is_unsigned_v<Block> && !std::is_same_v<Block, bool>,
+                  "Block must be an unsigned integer type");
+
 public:
+    /**
+     * @brief   Type of the blocks the bits are packed into
+     */
+    using block_type = Block;
+
+    using allocator_type = Allocator;
+
+    /**
+     * @brief   How many bits a single block holds
+     */
+    static constexpr std::size_t bits_per_block =
+        std::numeric_limits<block_type>::digits;
+
+    /**
+     * @brief   Value returned by the find functions when no bit was found
+     */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief   Proxy to a single bit, returned by operator[]
+     *
+     * Works like std::bitset::reference. The proxy is invalidated by any
+     * operation that changes the size of the bitset.
+     */
+    class reference
+    {
+    public:
+        reference(const reference&) noexcept = default;
+
+        reference& operator=(bool value) noexcept
+        {
+            if(value)
+                *block_ |= mask_;
+            else
+                *block_ &= static_cast<Block>(~mask_);
+            return *this;
+        }
+
+        reference& operator=(const reference& other) noexcept
+        {
+            return *this = static_cast<bool>(other);
+        }
+
+        operator bool() const noexcept { return (*block_ & mask_) != 0; }
+
+        bool operator~() const noexcept { return (*block_ & mask_) == 0; }
+
+        reference& flip() noexcept
+        {
+            *block_ ^= mask_;
+            return *this;
+        }
+
+    private:
+        friend class basic_dynamic_bitset;
+
+        reference(Block& block, std::size_t bit) noexcept
+            : block_(&block)
+            , mask_(static_cast<Block>(Block {1} << bit))
+        {
+        }
+
+        Block* block_;
+        Block  mask_;
+    };
+
     /**
      * @brief   Maximum number of bits the element can hold.
      */
     static inline std::size_t max_size() noexcept
     {
-        const std::vector<unsigned char> c;
-        return c.max_size();
+        return std::min(detail::block_buffer<Block, Allocator>::max_size(),
+                        std::numeric_limits<std::size_t>::max() /
+                            bits_per_block) *
+               bits_per_block;
     }
 
     /**
@@ -34,7 +145,15 @@ public:
      *
      * @throws std::invalid_argument if count is less than 0
      */
-    explicit dynamic_bitset(std::size_t count = 0, bool value = false);
+    explicit basic_dynamic_bitset(std::size_t      count = 0,
+                                  bool             value = false,
+                                  const Allocator& alloc = Allocator());
+
+    /**
+     * @brief Constructs an empty bitset that allocates its memory with
+     * @p alloc
+     */
+    explicit basic_dynamic_bitset(const Allocator& alloc) noexcept;
 
     /**
      * @brief Constructs a new dynamic_bitset with values inside @p bits
@@ -43,7 +162,30 @@ public:
      *
      * @throws std::length_error Thrown if @p bits is greater than @p max_size
      */
-    dynamic_bitset(std::initializer_list<bool> bits);
+    basic_dynamic_bitset(std::initializer_list<bool> bits,
+                         const Allocator&            alloc = Allocator());
+
+    basic_dynamic_bitset(const basic_dynamic_bitset& other) = default;
+
+    /**
+     * @brief Takes the bits of @p other, which is left empty
+     */
+    basic_dynamic_bitset(basic_dynamic_bitset&& other) noexcept;
+
+    /**
+     * @brief Copies @p other, but allocates the copy with @p alloc
+     */
+    basic_dynamic_bitset(const basic_dynamic_bitset& other,
+                         const Allocator&            alloc);
+
+    basic_dynamic_bitset& operator=(const basic_dynamic_bitset& other) =
+        default;
+    basic_dynamic_bitset& operator=(basic_dynamic_bitset&& other);
+
+    /**
+     * @brief Returns a copy of the allocator used by the bitset
+     */
+    allocator_type get_allocator() const noexcept;
 
     /**
      * @brief   Constructs and returns a new dynamic_bitset that is a subset of
@@ -56,9 +198,38 @@ public:
      * @throws std::invalid_argument Thrown if @p end is greater than begin +
      * bit_size_
      */
-    dynamic_bitset slice(std::size_t begin, std::size_t end);
+    basic_dynamic_bitset slice(std::size_t begin, std::size_t end) const;
+
+    /**
+     * @brief   Returns a view over the bits from @p begin to @p end, without
+     * copying them
+     *
+     * Same bounds as slice(). The view is invalidated by any operation that
+     * changes the size of the bitset, or by moving the bitset.
+     *
+     * @throws std::out_of_range Thrown if @p begin or @p end is out of range
+     * @throws std::invalid_argument Thrown if @p begin is greater than @p end
+     */
+    bit_span slice_view(std::size_t begin, std::size_t end);
+
+    /**
+     * @brief   Returns a read only view over the bits from @p begin to
+     * @p end, see slice_view()
+     */
+    const_bit_span slice_view(std::size_t begin, std::size_t end) const;
 
-    friend std::ostream& operator<<(std::ostream& os, const dynamic_bitset& dt);
+    /**
+     * @brief   Returns a view over every bit of the container
+     */
+    bit_span view() noexcept { return bit_span(data(), bit_size_); }
+
+    /**
+     * @brief   Returns a read only view over every bit of the container
+     */
+    const_bit_span view() const noexcept
+    {
+        return const_bit_span(data(), bit_size_);
+    }
 
     /**
      * @brief Erases every bit from the container
@@ -73,7 +244,7 @@ public:
      * @retval True If 2 bitsets are equivalents
      * @retval False If the 2 bitset are not equivalents.
      */
-    bool operator==(const dynamic_bitset& other) const noexcept;
+    bool operator==(const basic_dynamic_bitset& other) const noexcept;
 
     /**
      * @brief Insert @p len bits equals to @p val before @p pos.
@@ -194,6 +365,70 @@ public:
      */
     bool none() const noexcept;
 
+    /**
+     * @brief   Returns the number of bits that are set
+     */
+    std::size_t count() const noexcept;
+
+    /**
+     * @brief   Returns the number of bits that are set in [@p first, @p last)
+     *
+     * @throws std::out_of_range Thrown if @p last is greater than size()
+     * @throws std::invalid_argument Thrown if @p first is greater than
+     * @p last
+     */
+    std::size_t count(std::size_t first, std::size_t last) const;
+
+    /**
+     * @brief   Returns the position of the first set bit, or npos if no bit is
+     * set
+     */
+    std::size_t find_first() const noexcept;
+
+    /**
+     * @brief   Returns the position of the first set bit located after
+     * @p pos, or npos if there's none
+     */
+    std::size_t find_next(std::size_t pos) const noexcept;
+
+    /**
+     * @brief   Returns the position of the last set bit, or npos if no bit is
+     * set
+     */
+    std::size_t find_last() const noexcept;
+
+    /**
+     * @brief   Returns the position of the last set bit located before
+     * @p pos, or npos if there's none
+     */
+    std::size_t find_prev(std::size_t pos) const noexcept;
+
+    /**
+     * @brief   Returns the position of the first run of @p length consecutive
+     * bits equal to @p value located at or after @p from, or npos if there's
+     * none
+     *
+     * Full blocks are skipped or accumulated a block at a time, so searching
+     * a free run in an allocation map costs a few operations per block.
+     */
+    std::size_t find_first_run(bool        value,
+                               std::size_t length,
+                               std::size_t from = 0) const noexcept;
+
+    /**
+     * @brief   Returns a range over the positions of the set bits, in
+     * increasing order
+     *
+     * The range is invalidated by any operation that changes the size of the
+     * bitset.
+     *
+     * @code
+     * for(auto pos : bs.set_bits())
+     *     visit(pos);
+     * @endcode
+     */
+    set_bit_range<Block> set_bits() const noexcept;
+
     /**
      * @brief   Returns the number of bits in the container.
      * @return  The number of bit in the container.
@@ -206,8 +441,28 @@ public:
      */
     std::size_t byte_size() const noexcept;
 
+    /**
+     * @brief   Returns the number of blocks storing the bits currently in the
+     * container
+     */
+    std::size_t block_size() const noexcept;
+
+    /**
+     * @brief   Returns a pointer to the blocks storing the packed bits
+     */
+    block_type* blocks() noexcept;
+
+    /**
+     * @brief   Returns a pointer to the blocks storing the packed bits
+     */
+    const block_type* blocks() const noexcept;
+
     /**
      * @brief   Returns a pointer to the array storing the packed bits.
+     *
+     * The bytes are a view over the blocks, bit @p i being stored in byte
+     * i / 8 at position i % 8.
+     *
      * @return  The pointer to the array
      */
     unsigned char* data();
@@ -231,6 +486,64 @@ public:
      */
     bool test(std::size_t pos) const;
 
+    /**
+     * @brief   Returns the value of the bit located at @p pos without bound
+     * checking
+     *
+     * @p pos must be lower than size(). The check is only done when the
+     * library is built with CORGI_BINARY_CHECKED_ACCESS, or as an assert in
+     * debug builds.
+     */
+    bool test_unchecked(std::size_t pos) const noexcept(!checked_access)
+    {
+        check_access(pos);
+        detail::record(detail::counter::bit_operations);
+        return static_cast<bool>(
+            (blocks_[pos / bits_per_block] >> (pos % bits_per_block)) & 1);
+    }
+
+    /**
+     * @brief   Sets the bit located at @p pos to @p value without bound
+     * checking
+     *
+     * @p pos must be lower than size(), see test_unchecked()
+     */
+    void set_unchecked(std::size_t pos,
+                       bool value = true) noexcept(!checked_access)
+    {
+        check_access(pos);
+        detail::record(detail::counter::bit_operations);
+
+        const auto mask =
+            static_cast<Block>(block_type {1} << (pos % bits_per_block));
+        auto& block = blocks_[pos / bits_per_block];
+
+        // Branchless so the compiler can vectorize loops of sets
+        block = static_cast<Block>((block & ~mask) |
+                                   (static_cast<Block>(-Block {value}) & mask));
+    }
+
+    /**
+     * @brief   Returns a proxy to the bit located at @p pos, without bound
+     * checking
+     *
+     * @p pos must be lower than size(), see test_unchecked()
+     */
+    reference operator[](std::size_t pos) noexcept(!checked_access)
+    {
+        check_access(pos);
+        return reference(blocks_[pos / bits_per_block], pos % bits_per_block);
+    }
+
+    /**
+     * @brief   Returns the value of the bit located at @p pos, without bound
+     * checking
+     */
+    bool operator[](std::size_t pos) const noexcept(!checked_access)
+    {
+        return test_unchecked(pos);
+    }
+
     /**
      * @brief   Sets the bit located at @p pos to @p value
      *
@@ -271,6 +584,112 @@ public:
      */
     void reset();
 
+    /**
+     * @brief   Sets the bits in [@p first, @p last) to @p value
+     *
+     * @throws std::out_of_range Thrown if @p last is greater than size()
+     * @throws std::invalid_argument Thrown if @p first is greater than
+     * @p last
+     */
+    void set_range(std::size_t first, std::size_t last, bool value = true);
+
+    /**
+     * @brief   Sets the bits in [@p first, @p last) to false
+     *
+     * @throws std::out_of_range Thrown if @p last is greater than size()
+     * @throws std::invalid_argument Thrown if @p first is greater than
+     * @p last
+     */
+    void reset_range(std::size_t first, std::size_t last);
+
+    /**
+     * @brief   Sets the first run of @p length unset bits located at or after
+     * @p from, and returns its position
+     *
+     * Returns npos and leaves the bitset unchanged if there's no such run.
+     * The run is released with reset_range().
+     *
+     * @code
+     * const auto page = pages.claim_run(16);
+     * // ...
+     * pages.reset_range(page, page + 16);
+     * @endcode
+     */
+    std::size_t claim_run(std::size_t length, std::size_t from = 0);
+
+    /**
+     * @brief   Keeps the bits that are set in both the bitset and @p other
+     *
+     * @throws std::invalid_argument Thrown if @p other doesn't have the same
+     * size
+     */
+    basic_dynamic_bitset& operator&=(const basic_dynamic_bitset& other);
+
+    /**
+     * @brief   Sets the bits that are set in @p other
+     *
+     * @throws std::invalid_argument Thrown if @p other doesn't have the same
+     * size
+     */
+    basic_dynamic_bitset& operator|=(const basic_dynamic_bitset& other);
+
+    /**
+     * @brief   Flips the bits that are set in @p other
+     *
+     * @throws std::invalid_argument Thrown if @p other doesn't have the same
+     * size
+     */
+    basic_dynamic_bitset& operator^=(const basic_dynamic_bitset& other);
+
+    /**
+     * @brief   Resets the bits that are set in @p other (set difference)
+     *
+     * @throws std::invalid_argument Thrown if @p other doesn't have the same
+     * size
+     */
+    basic_dynamic_bitset& operator-=(const basic_dynamic_bitset& other);
+
+    /**
+     * @brief   Returns a copy of the bitset with every bit flipped
+     */
+    basic_dynamic_bitset operator~() const;
+
+    friend basic_dynamic_bitset operator&(const basic_dynamic_bitset& lhs,
+                                          const basic_dynamic_bitset& rhs)
+    {
+        auto result = lhs.make_result(rhs);
+        detail::and_blocks(result.blocks(), lhs.blocks(), rhs.blocks(),
+                           lhs.block_size());
+        return result;
+    }
+
+    friend basic_dynamic_bitset operator|(const basic_dynamic_bitset& lhs,
+                                          const basic_dynamic_bitset& rhs)
+    {
+        auto result = lhs.make_result(rhs);
+        detail::or_blocks(result.blocks(), lhs.blocks(), rhs.blocks(),
+                          lhs.block_size());
+        return result;
+    }
+
+    friend basic_dynamic_bitset operator^(const basic_dynamic_bitset& lhs,
+                                          const basic_dynamic_bitset& rhs)
+    {
+        auto result = lhs.make_result(rhs);
+        detail::xor_blocks(result.blocks(), lhs.blocks(), rhs.blocks(),
+                           lhs.block_size());
+        return result;
+    }
+
+    friend basic_dynamic_bitset operator-(const basic_dynamic_bitset& lhs,
+                                          const basic_dynamic_bitset& rhs)
+    {
+        auto result = lhs.make_result(rhs);
+        detail::andnot_blocks(result.blocks(), lhs.blocks(), rhs.blocks(),
+                              lhs.block_size());
+        return result;
+    }
+
     /**
      * @brief   Converts the bits to a ullong value.
      *
@@ -288,6 +707,34 @@ public:
     unsigned long long to_ullong(std::size_t pos, std::size_t len);
 
 private:
+    static constexpr Block block_all_set = static_cast<Block>(~Block {0});
+
+#if defined(CORGI_BINARY_CHECKED_ACCESS)
+    static constexpr bool checked_access = true;
+#else
+    static constexpr bool checked_access = false;
+#endif
+
+    /**
+     * @brief   Bound check of the unchecked accessors. Throws
+     * std::out_of_range with CORGI_BINARY_CHECKED_ACCESS, otherwise only
+     * asserts
+     */
+    void check_access([[maybe_unused]] std::size_t pos) const
+        noexcept(!checked_access)
+    {
+        if constexpr(checked_access)
+        {
+            if(pos >= bit_size_)
+                detail::raise<std::out_of_range>(
+                    "Argument pos is out of range");
+        }
+        else
+        {
+            assert(pos < bit_size_);
+        }
+    }
+
     /**
      * @brief   Checks if @p bit_index is in range.
      *
@@ -303,23 +750,190 @@ private:
      */
     void reallocate(std::size_t len);
 
+    /**
+     * @brief Grows the container by @p len bits and shifts the bits located
+     * at @p pos and after by @p len positions
+     *
+     * The @p len bits starting at @p pos keep their previous values
+     */
+    void make_room(std::size_t pos, std::size_t len);
+
+    /**
+     * @brief Checks the bounds of slice() and slice_view()
+     */
+    void check_slice(std::size_t begin, std::size_t end) const;
+
+    /**
+     * @brief Throws std::invalid_argument if @p other has a different size
+     */
+    void check_same_size(const basic_dynamic_bitset& other) const;
+
+    /**
+     * @brief Returns a bitset of the same size and allocator, ready to receive
+     * the result of a binary operation with @p other
+     *
+     * @throws std::invalid_argument Thrown if @p other has a different size
+     */
+    basic_dynamic_bitset make_result(const basic_dynamic_bitset& other) const;
+
+    /**
+     * @brief Sets to 0 the bits located after bit_size_ in the last block
+     */
+    void mask_last_block() noexcept;
+
+    /**
+     * @brief Drops the bits located after @p len, setting them to 0
+     */
+    void shrink_to(std::size_t len) noexcept;
+
     /**
      * @brief   Bits are stored here
+     *
+     * Bitsets of up to 128 bits are stored inline and don't allocate
      */
-    std::vector<unsigned char> bytes_;
+    detail::block_buffer<Block, Allocator> blocks_;
 
     /**
      * @brief How many bits are stored by the bitset
      */
-    std::size_t bit_size_;
+    std::size_t bit_size_ {0};
+
+    /**
+     * @brief How many bytes are exposed through data()
+     *
+     * Like the blocks, this only grows, so clearing the container doesn't
+     * release anything
+     */
+    std::size_t byte_size_ {0};
 };
 
-inline std::ostream& operator<<(std::ostream& os, const dynamic_bitset& bs)
+/**
+ * @brief   Writes the bits of @p bs as '0' and '1', bit 0 first
+ */
+template<class Block, class Allocator>
+std::ostream& operator<<(std::ostream&                                os,
+                         const basic_dynamic_bitset<Block, Allocator>& bs)
 {
-    for(std::size_t i = 0; i < bs.size(); i++)
-    {
-        os << bs.test(i);
-    }
+    detail::write_bits_text(os, bs.data(), bs.size());
     return os;
 }
+
+/**
+ * @brief   Returns the bits of @p bs as @p zero and @p one characters, bit 0
+ *          first
+ */
+template<class Block, class Allocator>
+std::string to_string(const basic_dynamic_bitset<Block, Allocator>& bs,
+                      char                                          zero = '0',
+                      char                                          one = '1')
+{
+    std::string text(bs.size(), zero);
+    detail::bits_to_chars(bs.data(), bs.size(), text.data(), zero, one);
+    return text;
+}
+
+/**
+ * @brief   Returns the bits of @p bs as a lower case hexadecimal number, the
+ *          most significant digit first
+ *
+ * Bit 0 is the lowest bit of the last digit. The string holds
+ * (size() + 3) / 4 digits, without prefix.
+ */
+template<class Block, class Allocator>
+std::string to_hex_string(const basic_dynamic_bitset<Block, Allocator>& bs)
+{
+    std::string text((bs.size() + 3) / 4, '0');
+    detail::bits_to_hex(bs.data(), bs.size(), text.data());
+    return text;
+}
+
+/**
+ * @brief   The default bitset, storing its bits inside 64 bits blocks
+ */
+using dynamic_bitset = basic_dynamic_bitset<>;
+
+namespace pmr
+{
+/**
+ * @brief   Bitset getting its memory from a std::pmr::memory_resource, for
+ *          instance a std::pmr::monotonic_buffer_resource
+ */
+using dynamic_bitset =
+    basic_dynamic_bitset<std::uint64_t,
+                         std::pmr::polymorphic_allocator<std::uint64_t>>;
+}    // namespace pmr
+
+/**
+ * @brief   Builds a bitset from the characters of @p text, bit 0 first, the
+ *          inverse of to_string()
+ *
+ * @throws std::invalid_argument if @p zero and @p one are the same or if
+ * @p text holds another character
+ */
+template<class Bitset = dynamic_bitset>
+Bitset from_string(std::string_view text, char zero = '0', char one = '1')
+{
+    if(zero == one)
+        detail::raise<std::invalid_argument>(
+            "Arguments zero and one are the same character");
+
+    Bitset bs(text.size());
+    if(!detail::chars_to_bits(text.data(), text.size(), bs.data(), zero, one))
+        detail::raise<std::invalid_argument>(
+            "Argument text holds an invalid character");
+    return bs;
+}
+
+/**
+ * @brief   Builds a bitset of @p size bits from the hexadecimal number
+ *          @p text, the inverse of to_hex_string()
+ *
+ * When @p size is npos, the bitset gets 4 bits per digit. A shorter @p text
+ * leaves the high bits to 0. Both cases are accepted.
+ *
+ * @throws std::invalid_argument if @p text holds something else than
+ * hexadecimal digits, or a bit set at or after @p size
+ */
+template<class Bitset = dynamic_bitset>
+Bitset from_hex_string(std::string_view text, std::size_t size = Bitset::npos)
+{
+    if(size == Bitset::npos)
+        size = text.size() * 4;
+
+    // Throws if the digit c holds a bit at position allowed_bits or higher
+    const auto check_digit = [](char c, int allowed_bits)
+    {
+        const int value = detail::hex_digit_value(c);
+        if(value < 0)
+            detail::raise<std::invalid_argument>(
+                "Argument text holds an invalid character");
+        if((value >> allowed_bits) != 0)
+            detail::raise<std::invalid_argument>(
+                "Argument text holds a bit set past size");
+    };
+
+    const std::size_t digits = (size + 3) / 4;
+    for(; text.size() > digits; text.remove_prefix(1))
+        check_digit(text.front(), 0);
+    if(text.size() == digits && size % 4 != 0)
+        check_digit(text.front(), static_cast<int>(size % 4));
+
+    Bitset bs(size);
+    if(!detail::hex_to_bits(text.data(), text.size(), bs.data()))
+        detail::raise<std::invalid_argument>(
+            "Argument text holds an invalid character");
+    return bs;
+}
+
+}    // namespace corgi::binary
+
+#include <corgi/binary/detail/dynamic_bitset.inl>
+
+namespace corgi::binary
+{
+// Both common instantiations are compiled once inside the library
+extern template class basic_dynamic_bitset<std::uint64_t>;
+extern template class basic_dynamic_bitset<
+    std::uint64_t,
+    std::pmr::polymorphic_allocator<std::uint64_t>>;
 }    // namespace corgi::binary
\ No newline at end of file
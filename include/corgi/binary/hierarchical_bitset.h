@@ -0,0 +1,197 @@
+#pragma once
+
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Bitset keeping summaries of its non empty words, to find set bits
+ *          without scanning the empty parts
+ *
+ * Level 0 holds the bits. Bit i of level n + 1 is set if word i of level n
+ * isn't 0, up to a level of a single word. A bitset of n bits has
+ * log64(n) levels, 4 levels covering 2^24 bits, and the summaries take
+ * about 1/63 of the size of the bits.
+ *
+ * find_first(), find_next(), find_last(), find_prev(), any() and none() walk
+ * the levels instead of the words, so they take O(log64 n) whatever the
+ * density. set() and reset() only touch the summaries when a word becomes
+ * non empty or empty.
+ *
+ * Only the set bits are summarized : a free slot map should store the free
+ * slots as set bits.
+ *
+ * @code
+ * hierarchical_bitset free_slots(1 << 24);
+ * free_slots.set(42);
+ * const auto slot = free_slots.find_first();
+ * free_slots.reset(slot);
+ * @endcode
+ */
+class hierarchical_bitset
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief   Constructs an empty bitset
+     */
+    hierarchical_bitset() noexcept = default;
+
+    /**
+     * @brief   Constructs a bitset of @p size bits set to 0
+     */
+    explicit hierarchical_bitset(std::size_t size);
+
+    /**
+     * @brief   Constructs a bitset holding a copy of @p bits
+     */
+    template<class Allocator>
+    explicit hierarchical_bitset(
+        const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+        : hierarchical_bitset(bits.size())
+    {
+        assign(bits.blocks());
+    }
+
+    /**
+     * @brief   Returns the number of bits of the bitset
+     */
+    std::size_t size() const noexcept { return size_; }
+
+    /**
+     * @brief   Returns the number of levels, the bits included
+     */
+    std::size_t level_count() const noexcept { return levels_.size(); }
+
+    /**
+     * @brief   Returns the words of level @p level, 0 being the bits
+     */
+    const std::vector<std::uint64_t>& level(std::size_t level) const
+    {
+        return levels_.at(level);
+    }
+
+    /**
+     * @brief   Returns the value of the bit located at @p pos
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    bool test(std::size_t pos) const;
+
+    /**
+     * @brief   Sets the bit located at @p pos to @p value
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    void set(std::size_t pos, bool value = true);
+
+    /**
+     * @brief   Sets the bit located at @p pos to false
+     *
+     * @throws std::out_of_range Thrown if @p pos isn't lower than size()
+     */
+    void reset(std::size_t pos);
+
+    /**
+     * @brief   Sets every bit to false
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief   Returns true if any bit is set, in constant time
+     */
+    bool any() const noexcept
+    {
+        return !levels_.empty() && levels_.back()[0] != 0;
+    }
+
+    /**
+     * @brief   Returns true if no bit is set, in constant time
+     */
+    bool none() const noexcept { return !any(); }
+
+    /**
+     * @brief   Returns the number of bits that are set
+     */
+    std::size_t count() const noexcept;
+
+    /**
+     * @brief   Returns the position of the first set bit, or npos if no bit is
+     * set
+     */
+    std::size_t find_first() const noexcept { return find_next(npos); }
+
+    /**
+     * @brief   Returns the position of the first set bit located after
+     * @p pos, or npos if there's none
+     */
+    std::size_t find_next(std::size_t pos) const noexcept;
+
+    /**
+     * @brief   Returns the position of the last set bit, or npos if no bit is
+     * set
+     */
+    std::size_t find_last() const noexcept { return find_prev(size_); }
+
+    /**
+     * @brief   Returns the position of the last set bit located before
+     * @p pos, or npos if there's none
+     */
+    std::size_t find_prev(std::size_t pos) const noexcept;
+
+    /**
+     * @brief   Returns a copy of the bits inside a dynamic_bitset
+     */
+    template<class Allocator = std::allocator<std::uint64_t>>
+    basic_dynamic_bitset<std::uint64_t, Allocator>
+    to_bitset(const Allocator& alloc = Allocator()) const
+    {
+        basic_dynamic_bitset<std::uint64_t, Allocator> bits(size_, false,
+                                                            alloc);
+        if(!levels_.empty())
+            std::copy(levels_[0].begin(), levels_[0].end(), bits.blocks());
+        return bits;
+    }
+
+    /**
+     * @brief   Returns true if both bitsets hold the same bits
+     */
+    friend bool operator==(const hierarchical_bitset& lhs,
+                           const hierarchical_bitset& rhs) noexcept
+    {
+        // The summaries only depend on the bits
+        return lhs.size_ == rhs.size_ && lhs.levels_ == rhs.levels_;
+    }
+
+private:
+    /**
+     * @brief   Copies @p blocks into the bits and builds the summaries
+     */
+    void assign(const std::uint64_t* blocks);
+
+    /**
+     * @brief   Returns the position of the first set bit below the bit
+     *          located at @p pos on level @p level, which must be set
+     */
+    std::size_t descend_first(std::size_t level,
+                              std::size_t pos) const noexcept;
+
+    /**
+     * @brief   Returns the position of the last set bit below the bit
+     *          located at @p pos on level @p level, which must be set
+     */
+    std::size_t descend_last(std::size_t level, std::size_t pos) const noexcept;
+
+    void check_pos(std::size_t pos) const;
+
+    std::vector<std::vector<std::uint64_t>> levels_;
+    std::size_t                             size_ {0};
+};
+}    // namespace corgi::binary
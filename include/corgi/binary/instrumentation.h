@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Counters of the work done by dynamic_bitset, for metrics exporters.
+ *
+ * They only exist when the library is built with
+ * CORGI_BINARY_INSTRUMENTATION (the CMake option of the same name).
+ * Otherwise the hooks are empty inline functions, and read_instrumentation()
+ * returns zeros.
+ *
+ * Each thread increments its own counters with plain relaxed stores, so the
+ * threads never fight over a cache line. read_instrumentation() sums the
+ * counters of every thread, including the ones that exited.
+ *
+ * @code
+ * const auto counters = corgi::binary::read_instrumentation();
+ * metrics.gauge("bitset.reallocations", counters.reallocations);
+ * @endcode
+ */
+namespace corgi::binary
+{
+/**
+ * @brief   Values of the counters at the time read_instrumentation() was
+ *          called
+ */
+struct instrumentation_snapshot
+{
+    /**
+     * @brief   Moves of the blocks to a larger heap array
+     */
+    std::uint64_t reallocations {0};
+
+    /**
+     * @brief   Bytes requested from the allocators
+     */
+    std::uint64_t bytes_allocated {0};
+
+    /**
+     * @brief   Bytes copied by reallocations, copies, slices, and moved by
+     *          insert() and erase()
+     */
+    std::uint64_t bytes_copied {0};
+
+    /**
+     * @brief   Calls to slice()
+     */
+    std::uint64_t slices {0};
+
+    /**
+     * @brief   Reads and writes of a single bit
+     */
+    std::uint64_t bit_operations {0};
+
+    /**
+     * @brief   Blocks processed by the operations working on whole blocks
+     */
+    std::uint64_t word_operations {0};
+
+    /**
+     * @brief   Exceptions thrown by dynamic_bitset
+     */
+    std::uint64_t exceptions {0};
+};
+
+/**
+ * @brief   True if the library counts its work
+ */
+#if defined(CORGI_BINARY_INSTRUMENTATION)
+inline constexpr bool instrumentation_enabled = true;
+#else
+inline constexpr bool instrumentation_enabled = false;
+#endif
+
+/**
+ * @brief   Returns the sum of the counters of every thread
+ */
+instrumentation_snapshot read_instrumentation() noexcept;
+
+/**
+ * @brief   Sets every counter back to 0
+ *
+ * Increments done by other threads while the counters are reset can be
+ * lost.
+ */
+void reset_instrumentation() noexcept;
+
+namespace detail
+{
+enum class counter : std::size_t
+{
+    reallocations,
+    bytes_allocated,
+    bytes_copied,
+    slices,
+    bit_operations,
+    word_operations,
+    exceptions
+};
+
+inline constexpr std::size_t counter_count = 7;
+
+using thread_counters = std::array<std::atomic<std::uint64_t>, counter_count>;
+
+#if defined(CORGI_BINARY_INSTRUMENTATION)
+/**
+ * @brief   Returns the counters of the calling thread
+ */
+thread_counters& local_counters() noexcept;
+
+inline void record(counter c, std::uint64_t n = 1) noexcept
+{
+    // Only this thread writes the value, the atomic is for the readers
+    auto& value = local_counters()[static_cast<std::size_t>(c)];
+    value.store(value.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+#else
+inline void record(counter, std::uint64_t = 1) noexcept {}
+#endif
+
+/**
+ * @brief   Counts the exception, then throws it
+ */
+template<class Exception, class... Args>
+[[noreturn]] void raise(Args&&... args)
+{
+    record(counter::exceptions);
+    throw Exception(std::forward<Args>(args)...);
+}
+}    // namespace detail
+}    // namespace corgi::binary
@@ -0,0 +1,582 @@
+#pragma once
+
+#include <corgi/binary/detail/block_buffer.h>
+#include <corgi/binary/detail/block_ops.h>
+#include <corgi/binary/packing.h>
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Width parameter of packed_int_vector meaning that the width is
+ *          given to the constructor
+ */
+inline constexpr std::size_t dynamic_width = 0;
+
+/**
+ * @brief   Random access container of unsigned integers stored on @p Width
+ *          bits each
+ *
+ * Integers are packed one after the other inside 64 bits blocks, like the
+ * bits of a dynamic_bitset, so 20 bits identifiers take 20 bits instead of
+ * 32. Reading or writing an integer touches at most 2 blocks and never loops
+ * over bits. Bulk append and copy_to() go through the pack() and unpack()
+ * kernels.
+ *
+ * An extra block is always kept after the last integer, so an integer
+ * straddling 2 blocks is read without branching.
+ *
+ * @tparam Width        Number of bits of every integer, in [1, 64], or
+ *                      dynamic_width to give it to the constructor
+ * @tparam Allocator    Allocator of std::uint64_t
+ */
+template<std::size_t Width = dynamic_width,
+         class Allocator   = std::allocator<std::uint64_t>>
+class packed_int_vector
+{
+    static_assert(Width <= 64, "Width must be at most 64 bits");
+
+public:
+    using value_type     = std::uint64_t;
+    using size_type      = std::size_t;
+    using allocator_type = Allocator;
+
+    class const_iterator;
+
+    /**
+     * @brief   Constructs an empty vector. Only available when the width is
+     *          known at compile time
+     */
+    packed_int_vector() noexcept
+        requires(Width != dynamic_width)
+        : width_(Width)
+    {
+    }
+
+    /**
+     * @brief   Constructs an empty vector of integers of @p width bits
+     *
+     * @throws std::invalid_argument Thrown if @p width isn't in [1, 64]
+     */
+    explicit packed_int_vector(std::size_t      width,
+                               const Allocator& alloc = Allocator())
+        requires(Width == dynamic_width)
+        : width_(width)
+        , blocks_(alloc)
+    {
+        if(width == 0 || width > 64)
+            throw std::invalid_argument("Argument width must be in [1, 64]");
+    }
+
+    /**
+     * @brief   Constructs a vector of @p count integers equal to @p value
+     */
+    explicit packed_int_vector(std::size_t      count,
+                               value_type       value = 0,
+                               const Allocator& alloc = Allocator())
+        requires(Width != dynamic_width)
+        : width_(Width)
+        , blocks_(alloc)
+    {
+        resize(count, value);
+    }
+
+    /**
+     * @brief   Constructs a vector holding the integers of @p values
+     */
+    packed_int_vector(std::initializer_list<value_type> values,
+                      const Allocator&                  alloc = Allocator())
+        requires(Width != dynamic_width)
+        : width_(Width)
+        , blocks_(alloc)
+    {
+        reserve(values.size());
+        for(const auto value : values)
+            push_back(value);
+    }
+
+    /**
+     * @brief   Takes the integers of @p other, which is left empty
+     */
+    packed_int_vector(packed_int_vector&& other) noexcept
+        : width_(other.width_)
+        , blocks_(std::move(other.blocks_))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    packed_int_vector(const packed_int_vector& other) = default;
+
+    packed_int_vector& operator=(const packed_int_vector& other) = default;
+
+    packed_int_vector& operator=(packed_int_vector&& other)
+    {
+        if(this == &other)
+            return *this;
+
+        width_  = other.width_;
+        blocks_ = std::move(other.blocks_);
+        size_   = std::exchange(other.size_, 0);
+        other.blocks_.resize(0);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return blocks_.get_allocator();
+    }
+
+    /**
+     * @brief   Number of bits of every integer
+     */
+    std::size_t width() const noexcept
+    {
+        if constexpr(Width != dynamic_width)
+            return Width;
+        else
+            return width_;
+    }
+
+    /**
+     * @brief   Largest integer the vector can store
+     */
+    value_type max_value() const noexcept
+    {
+        return detail::low_mask<value_type>(width());
+    }
+
+    std::size_t size() const noexcept { return size_; }
+
+    bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief   Number of integers the vector can hold without reallocating
+     */
+    std::size_t capacity() const noexcept
+    {
+        return blocks_.capacity() == 0
+                   ? 0
+                   : (blocks_.capacity() - 1) * 64 / width();
+    }
+
+    /**
+     * @brief   Makes room for @p count integers
+     */
+    void reserve(std::size_t count) { blocks_.reserve(block_count(count)); }
+
+    /**
+     * @brief   Returns the number of bytes used by the integers
+     */
+    std::size_t byte_size() const noexcept
+    {
+        return detail::byte_count(size_ * width());
+    }
+
+    /**
+     * @brief   Returns the integer located at @p index
+     *
+     * @throws std::out_of_range Thrown if @p index isn't lower than size()
+     */
+    value_type get(std::size_t index) const
+    {
+        if(index >= size_)
+            throw std::out_of_range("Argument index is out of range");
+        return get_unchecked(index);
+    }
+
+    /**
+     * @brief   Sets the integer located at @p index to @p value. Bits of
+     *          @p value above width() are ignored
+     *
+     * @throws std::out_of_range Thrown if @p index isn't lower than size()
+     */
+    void set(std::size_t index, value_type value)
+    {
+        if(index >= size_)
+            throw std::out_of_range("Argument index is out of range");
+        set_unchecked(index, value);
+    }
+
+    /**
+     * @brief   Returns the integer located at @p index, without bound
+     *          checking
+     */
+    value_type get_unchecked(std::size_t index) const noexcept
+    {
+        assert(index < size_);
+
+        const auto bit    = index * width();
+        const auto block  = bit / 64;
+        const auto offset = bit % 64;
+
+        // The double shift gives 0 when offset is 0 instead of shifting by
+        // 64, which is undefined
+        const auto low  = blocks_[block] >> offset;
+        const auto high = (blocks_[block + 1] << 1) << (63 - offset);
+        return (low | high) & max_value();
+    }
+
+    /**
+     * @brief   Sets the integer located at @p index to @p value, without
+     *          bound checking
+     */
+    void set_unchecked(std::size_t index, value_type value) noexcept
+    {
+        assert(index < size_);
+
+        const auto bit    = index * width();
+        const auto block  = bit / 64;
+        const auto offset = bit % 64;
+        const auto mask   = max_value();
+
+        value &= mask;
+
+        // The next block is always written. When the integer doesn't reach
+        // it, its mask is empty and the block is left untouched
+        blocks_[block] = (blocks_[block] & ~(mask << offset)) |
+                         (value << offset);
+
+        const auto high_mask = (mask >> 1) >> (63 - offset);
+        blocks_[block + 1]   = (blocks_[block + 1] & ~high_mask) |
+                             ((value >> 1) >> (63 - offset));
+    }
+
+    /**
+     * @brief   Returns the integer located at @p index, without bound
+     *          checking
+     */
+    value_type operator[](std::size_t index) const noexcept
+    {
+        return get_unchecked(index);
+    }
+
+    value_type front() const { return get(0); }
+
+    value_type back() const
+    {
+        if(empty())
+            throw std::out_of_range("The vector is empty");
+        return get_unchecked(size_ - 1);
+    }
+
+    /**
+     * @brief   Adds @p value at the end of the vector
+     */
+    void push_back(value_type value)
+    {
+        grow_to(size_ + 1);
+        set_unchecked(size_++, value);
+    }
+
+    /**
+     * @brief   Removes the last integer. Does nothing if the vector is empty
+     */
+    void pop_back() noexcept
+    {
+        if(size_ != 0)
+            shrink_to(size_ - 1);
+    }
+
+    /**
+     * @brief   Adds the integers of @p values at the end of the vector
+     *
+     * Integers are packed by the pack() kernel when width() is at most 32.
+     */
+    void append(std::span<const std::uint32_t> values)
+    {
+        grow_to(size_ + values.size());
+
+        if(width() <= 32)
+        {
+            pack(mutable_data(), size_ * width(), width(), values.size(),
+                 values.data());
+            size_ += values.size();
+            return;
+        }
+
+        for(const auto value : values)
+            set_unchecked(size_++, value);
+    }
+
+    /**
+     * @brief   Adds the integers of @p values at the end of the vector
+     */
+    void append(std::span<const std::uint64_t> values)
+    {
+        grow_to(size_ + values.size());
+        for(const auto value : values)
+            set_unchecked(size_++, value);
+    }
+
+    /**
+     * @brief   Copies the @p count integers starting at @p first to @p out
+     *
+     * Integers are decoded by the unpack() kernel.
+     *
+     * @throws std::out_of_range Thrown if the range isn't inside the vector
+     * @throws std::invalid_argument Thrown if width() is greater than 32
+     */
+    void copy_to(std::size_t first, std::size_t count, std::uint32_t* out) const
+    {
+        check_range(first, count);
+
+        if(width() > 32)
+            throw std::invalid_argument(
+                "Integers wider than 32 bits can't be copied to uint32_t");
+
+        unpack(data(), first * width(), width(), count, out);
+    }
+
+    /**
+     * @brief   Copies the @p count integers starting at @p first to @p out
+     *
+     * @throws std::out_of_range Thrown if the range isn't inside the vector
+     */
+    void copy_to(std::size_t first, std::size_t count, std::uint64_t* out) const
+    {
+        check_range(first, count);
+        for(std::size_t i = 0; i < count; i++)
+            out[i] = get_unchecked(first + i);
+    }
+
+    /**
+     * @brief   Resizes the vector to @p count integers. New integers are
+     *          equal to @p value
+     */
+    void resize(std::size_t count, value_type value = 0)
+    {
+        if(count <= size_)
+        {
+            shrink_to(count);
+            return;
+        }
+
+        grow_to(count);
+
+        // Storage past size() is always 0, so only non zero values need to be
+        // written
+        const auto previous = size_;
+        size_               = count;
+        if((value & max_value()) != 0)
+        {
+            for(auto i = previous; i < count; i++)
+                set_unchecked(i, value);
+        }
+    }
+
+    /**
+     * @brief   Removes every integer. The memory is kept
+     */
+    void clear() noexcept { shrink_to(0); }
+
+    /**
+     * @brief   Returns the integers as little endian packed bytes
+     */
+    const unsigned char* data() const noexcept
+    {
+        return reinterpret_cast<const unsigned char*>(blocks_.data());
+    }
+
+    /**
+     * @brief   Returns the blocks storing the integers
+     */
+    const std::uint64_t* blocks() const noexcept { return blocks_.data(); }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+
+    const_iterator end() const noexcept { return const_iterator(this, size_); }
+
+    friend bool operator==(const packed_int_vector& lhs,
+                           const packed_int_vector& rhs) noexcept
+    {
+        if(lhs.width() != rhs.width() || lhs.size() != rhs.size())
+            return false;
+
+        // Storage past size() is always 0, whole blocks can be compared
+        const auto count =
+            detail::block_count<std::uint64_t>(lhs.size_ * lhs.width());
+        return std::equal(lhs.blocks(), lhs.blocks() + count, rhs.blocks());
+    }
+
+    /**
+     * @brief   Random access iterator over the integers of the vector
+     */
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = std::uint64_t;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = std::uint64_t;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept
+        {
+            return vector_->get_unchecked(index_);
+        }
+
+        reference operator[](difference_type n) const noexcept
+        {
+            return vector_->get_unchecked(
+                static_cast<std::size_t>(static_cast<difference_type>(index_) +
+                                         n));
+        }
+
+        const_iterator& operator++() noexcept
+        {
+            index_++;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            auto copy = *this;
+            index_++;
+            return copy;
+        }
+
+        const_iterator& operator--() noexcept
+        {
+            index_--;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept
+        {
+            auto copy = *this;
+            index_--;
+            return copy;
+        }
+
+        const_iterator& operator+=(difference_type n) noexcept
+        {
+            index_ = static_cast<std::size_t>(
+                static_cast<difference_type>(index_) + n);
+            return *this;
+        }
+
+        const_iterator& operator-=(difference_type n) noexcept
+        {
+            return *this += -n;
+        }
+
+        friend const_iterator operator+(const_iterator  it,
+                                        difference_type n) noexcept
+        {
+            return it += n;
+        }
+
+        friend const_iterator operator+(difference_type n,
+                                        const_iterator  it) noexcept
+        {
+            return it += n;
+        }
+
+        friend const_iterator operator-(const_iterator  it,
+                                        difference_type n) noexcept
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const const_iterator& lhs,
+                                         const const_iterator& rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs.index_) -
+                   static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const const_iterator& lhs,
+                               const const_iterator& rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const const_iterator& lhs,
+                                const const_iterator& rhs) noexcept
+        {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        friend class packed_int_vector;
+
+        const_iterator(const packed_int_vector* vector,
+                       std::size_t              index) noexcept
+            : vector_(vector)
+            , index_(index)
+        {
+        }
+
+        const packed_int_vector* vector_ {nullptr};
+        std::size_t              index_ {0};
+    };
+
+private:
+    /**
+     * @brief   Number of blocks needed by @p count integers, padding block
+     *          included
+     */
+    std::size_t block_count(std::size_t count) const noexcept
+    {
+        return detail::block_count<std::uint64_t>(count * width()) + 1;
+    }
+
+    unsigned char* mutable_data() noexcept
+    {
+        return reinterpret_cast<unsigned char*>(blocks_.data());
+    }
+
+    void check_range(std::size_t first, std::size_t count) const
+    {
+        if(first > size_ || count > size_ - first)
+            throw std::out_of_range("Range is out of the vector");
+    }
+
+    /**
+     * @brief   Makes sure the blocks can hold @p count integers
+     */
+    void grow_to(std::size_t count)
+    {
+        if(count > (std::numeric_limits<std::size_t>::max() - 64) / width())
+            throw std::length_error("Integer count is greater than limit");
+
+        const auto blocks = block_count(count);
+        if(blocks > blocks_.size())
+            blocks_.resize(blocks, 0);
+    }
+
+    /**
+     * @brief   Drops the integers located after @p count, setting their bits
+     *          to 0
+     */
+    void shrink_to(std::size_t count) noexcept
+    {
+        if(blocks_.size() == 0)
+            return;
+
+        const auto first = count * width();
+        const auto last  = size_ * width();
+        detail::fill_bits(blocks_.data(), first, last, false);
+        size_ = count;
+    }
+
+    std::size_t                                    width_;
+    detail::block_buffer<std::uint64_t, Allocator> blocks_;
+    std::size_t                                    size_ {0};
+};
+
+}    // namespace corgi::binary
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Decodes @p count integers of @p width bits packed one after the
+ *          other, starting at bit @p bit_offset of @p src
+ *
+ * Bits are laid out like bit_reader and bit_writer expect them : the first
+ * integer starts at the least significant bit of its first byte. Only the
+ * bytes covering the packed integers are read.
+ *
+ * Every width has its own kernel, vectorized with AVX2 when the CPU supports
+ * it (see simd.h).
+ *
+ * @param src           Packed integers
+ * @param bit_offset    Position of the first integer in @p src, in bits
+ * @param width         Number of bits of every integer, in [0, 32]
+ * @param count         Number of integers to decode
+ * @param out           Receives the @p count decoded integers
+ *
+ * @throws std::invalid_argument Thrown if @p width is greater than 32
+ */
+void unpack(const unsigned char* src,
+            std::size_t          bit_offset,
+            std::size_t          width,
+            std::size_t          count,
+            std::uint32_t*       out);
+
+/**
+ * @brief   Packs the @p width low bits of the @p count integers of @p in one
+ *          after the other, starting at bit @p bit_offset of @p dst
+ *
+ * Bits of @p dst outside the packed range are left untouched, and bits of
+ * the integers above @p width are ignored. This is the inverse of unpack().
+ *
+ * @throws std::invalid_argument Thrown if @p width is greater than 32
+ */
+void pack(unsigned char*       dst,
+          std::size_t          bit_offset,
+          std::size_t          width,
+          std::size_t          count,
+          const std::uint32_t* in);
+
+}    // namespace corgi::binary
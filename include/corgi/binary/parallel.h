@@ -0,0 +1,326 @@
+#pragma once
+
+#include <corgi/binary/detail/block_ops.h>
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+/**
+ * Multi threaded versions of the bulk operations of dynamic_bitset.
+ *
+ * Each function takes a parallel_policy first, like the std algorithms take
+ * an execution policy. The blocks are split in one range per thread, on
+ * the cache line boundaries of their address so 2 threads never write to
+ * the same line. The threads come from a pool shared by the whole library,
+ * started the first time it's needed.
+ *
+ * Bitsets with less blocks than the threshold of the policy are processed
+ * by the calling thread only, since waking the pool costs more than the
+ * operation itself.
+ *
+ * @code
+ * const auto set_bits = count(parallel, huge);
+ * and_assign(parallel_policy {.thread_count = 16}, huge, mask);
+ * @endcode
+ */
+namespace corgi::binary
+{
+/**
+ * @brief   How a bulk operation is split between threads
+ */
+struct parallel_policy
+{
+    /**
+     * @brief   Default serial_threshold, 4 MiB of blocks
+     */
+    static constexpr std::size_t default_serial_threshold = 1 << 19;
+
+    /**
+     * @brief   Number of threads working on the operation, counting the
+     *          calling thread. 0 uses every hardware thread
+     */
+    std::size_t thread_count {0};
+
+    /**
+     * @brief   Bitsets with less blocks than that are processed serially
+     */
+    std::size_t serial_threshold {default_serial_threshold};
+};
+
+/**
+ * @brief   Default policy, using every hardware thread
+ */
+inline constexpr parallel_policy parallel {};
+
+namespace detail
+{
+/**
+ * @brief   Calls @p function(first, last) on ranges covering the
+ *          @p block_count blocks of @p blocks, from several threads
+ *
+ * The ranges start on 64 bytes boundaries of the address of @p blocks,
+ * which the allocators don't necessarily align. Returns once every call
+ * returned. An exception thrown by @p function is rethrown.
+ */
+void parallel_for(
+    const parallel_policy&                                policy,
+    const std::uint64_t*                                  blocks,
+    std::size_t                                           block_count,
+    const std::function<void(std::size_t, std::size_t)>& function);
+
+/**
+ * @brief   Sets to 0 the bits past @p bit_size in the last block
+ */
+inline void mask_last_block(std::uint64_t* blocks, std::size_t bit_size)
+{
+    if(bit_size % 64 != 0)
+        blocks[bit_size / 64] &= low_mask<std::uint64_t>(bit_size % 64);
+}
+
+template<class Allocator>
+void check_same_size(const basic_dynamic_bitset<std::uint64_t, Allocator>& a,
+                     const basic_dynamic_bitset<std::uint64_t, Allocator>& b)
+{
+    if(a.size() != b.size())
+        throw std::invalid_argument(
+            "Argument other doesn't have the same size as the bitset");
+}
+}    // namespace detail
+
+/**
+ * @brief   Returns the number of bits that are set
+ */
+template<class Allocator>
+std::size_t count(const parallel_policy&                                policy,
+                  const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+{
+    std::atomic<std::size_t> total {0};
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             total.fetch_add(detail::count_blocks(
+                                                 bits.blocks() + first,
+                                                 last - first),
+                                             std::memory_order_relaxed);
+                         });
+    return total.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief   Returns true if any bit is set
+ */
+template<class Allocator>
+bool any(const parallel_policy&                                policy,
+         const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+{
+    std::atomic<bool> found {false};
+    detail::parallel_for(
+        policy, bits.blocks(), bits.block_size(),
+        [&](std::size_t first, std::size_t last)
+        {
+            // Ranges starting after a set bit was found are skipped
+            if(!found.load(std::memory_order_relaxed) &&
+               detail::find_nonzero_block(bits.blocks(), first, last) != last)
+                found.store(true, std::memory_order_relaxed);
+        });
+    return found.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief   Returns true if every bit is set, or if the bitset is empty
+ */
+template<class Allocator>
+bool all(const parallel_policy&                                policy,
+         const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+{
+    // The last block is checked apart since it can be partially used
+    const auto full_blocks = bits.size() / 64;
+
+    std::atomic<bool> missing {false};
+    detail::parallel_for(
+        policy, bits.blocks(), full_blocks,
+        [&](std::size_t first, std::size_t last)
+        {
+            if(!missing.load(std::memory_order_relaxed) &&
+               !std::all_of(bits.blocks() + first, bits.blocks() + last,
+                            [](std::uint64_t block)
+                            { return block == ~std::uint64_t {0}; }))
+                missing.store(true, std::memory_order_relaxed);
+        });
+
+    if(missing.load(std::memory_order_relaxed))
+        return false;
+
+    const auto remaining = bits.size() % 64;
+    return remaining == 0 || bits.blocks()[full_blocks] ==
+                                 detail::low_mask<std::uint64_t>(remaining);
+}
+
+/**
+ * @brief   Returns true if no bit is set
+ */
+template<class Allocator>
+bool none(const parallel_policy&                                policy,
+          const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+{
+    return !any(policy, bits);
+}
+
+/**
+ * @brief   Sets every bit to @p value
+ */
+template<class Allocator>
+void set(const parallel_policy&                          policy,
+         basic_dynamic_bitset<std::uint64_t, Allocator>& bits,
+         bool                                            value = true)
+{
+    const auto block = value ? ~std::uint64_t {0} : std::uint64_t {0};
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             std::fill(bits.blocks() + first,
+                                       bits.blocks() + last, block);
+                         });
+    detail::mask_last_block(bits.blocks(), bits.size());
+}
+
+/**
+ * @brief   Sets every bit to false
+ */
+template<class Allocator>
+void reset(const parallel_policy&                          policy,
+           basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+{
+    set(policy, bits, false);
+}
+
+/**
+ * @brief   Flips every bit
+ */
+template<class Allocator>
+void flip(const parallel_policy&                          policy,
+          basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+{
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             detail::not_blocks(bits.blocks() + first,
+                                                bits.blocks() + first,
+                                                last - first);
+                         });
+    detail::mask_last_block(bits.blocks(), bits.size());
+}
+
+/**
+ * @brief   Returns true if both bitsets hold the same bits
+ */
+template<class Allocator>
+bool equal(const parallel_policy&                                policy,
+           const basic_dynamic_bitset<std::uint64_t, Allocator>& lhs,
+           const basic_dynamic_bitset<std::uint64_t, Allocator>& rhs)
+{
+    if(lhs.size() != rhs.size())
+        return false;
+
+    std::atomic<bool> different {false};
+    detail::parallel_for(
+        policy, lhs.blocks(), lhs.block_size(),
+        [&](std::size_t first, std::size_t last)
+        {
+            if(!different.load(std::memory_order_relaxed) &&
+               !std::equal(lhs.blocks() + first, lhs.blocks() + last,
+                           rhs.blocks() + first))
+                different.store(true, std::memory_order_relaxed);
+        });
+    return !different.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief   Keeps the bits that are set in both @p bits and @p other
+ *
+ * @throws std::invalid_argument Thrown if @p other doesn't have the same
+ * size
+ */
+template<class Allocator>
+void and_assign(const parallel_policy&                                policy,
+                basic_dynamic_bitset<std::uint64_t, Allocator>&       bits,
+                const basic_dynamic_bitset<std::uint64_t, Allocator>& other)
+{
+    detail::check_same_size(bits, other);
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             detail::and_blocks(
+                                 bits.blocks() + first, bits.blocks() + first,
+                                 other.blocks() + first, last - first);
+                         });
+}
+
+/**
+ * @brief   Sets the bits that are set in @p other
+ *
+ * @throws std::invalid_argument Thrown if @p other doesn't have the same
+ * size
+ */
+template<class Allocator>
+void or_assign(const parallel_policy&                                policy,
+               basic_dynamic_bitset<std::uint64_t, Allocator>&       bits,
+               const basic_dynamic_bitset<std::uint64_t, Allocator>& other)
+{
+    detail::check_same_size(bits, other);
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             detail::or_blocks(
+                                 bits.blocks() + first, bits.blocks() + first,
+                                 other.blocks() + first, last - first);
+                         });
+}
+
+/**
+ * @brief   Flips the bits that are set in @p other
+ *
+ * @throws std::invalid_argument Thrown if @p other doesn't have the same
+ * size
+ */
+template<class Allocator>
+void xor_assign(const parallel_policy&                                policy,
+                basic_dynamic_bitset<std::uint64_t, Allocator>&       bits,
+                const basic_dynamic_bitset<std::uint64_t, Allocator>& other)
+{
+    detail::check_same_size(bits, other);
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             detail::xor_blocks(
+                                 bits.blocks() + first, bits.blocks() + first,
+                                 other.blocks() + first, last - first);
+                         });
+}
+
+/**
+ * @brief   Resets the bits that are set in @p other (set difference)
+ *
+ * @throws std::invalid_argument Thrown if @p other doesn't have the same
+ * size
+ */
+template<class Allocator>
+void andnot_assign(const parallel_policy&                                policy,
+                   basic_dynamic_bitset<std::uint64_t, Allocator>&       bits,
+                   const basic_dynamic_bitset<std::uint64_t, Allocator>& other)
+{
+    detail::check_same_size(bits, other);
+    detail::parallel_for(policy, bits.blocks(), bits.block_size(),
+                         [&](std::size_t first, std::size_t last)
+                         {
+                             detail::andnot_blocks(
+                                 bits.blocks() + first, bits.blocks() + first,
+                                 other.blocks() + first, last - first);
+                         });
+}
+}    // namespace corgi::binary
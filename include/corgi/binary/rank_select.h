@@ -0,0 +1,170 @@
+#pragma once
+
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace corgi::binary
+{
+/**
+ * @brief   Auxiliary index answering rank and select queries over a
+ *          dynamic_bitset with 64 bits blocks
+ *
+ * rank(pos) counts the set bits located before @p pos, select(k) returns the
+ * position of the k-th set bit. Both take a constant number of memory
+ * accesses, select adding a short binary search between two samples.
+ *
+ * The layout follows rank9 : every 512 bits superblock stores the number of
+ * set bits before it, plus the 7 counts of its words packed on 9 bits each.
+ * That's 128 bits per 512 bits, so the index takes 25% of the bitset size.
+ * Select samples the superblock of every 8192th set bit, which adds at most
+ * 1/128 bits per bit.
+ *
+ * The index reads the blocks of the bitset during queries : after the bitset
+ * is modified, update() (or build()) must be called before the next query.
+ * update() only recomputes the superblocks covering the modified bits.
+ *
+ * @code
+ * rank_select index(bits);
+ * const auto before = index.rank(1000);
+ * bits.set(std::size_t {10});
+ * index.update(bits, 10, 11);
+ * @endcode
+ */
+class rank_select
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief   Bits covered by a superblock
+     */
+    static constexpr std::size_t superblock_bits = 512;
+
+    /**
+     * @brief   Number of set bits between 2 select samples
+     */
+    static constexpr std::size_t select_sample = 8192;
+
+    /**
+     * @brief   Constructs an index over an empty bitset
+     */
+    rank_select() noexcept = default;
+
+    /**
+     * @brief   Constructs the index of @p bits
+     */
+    template<class Allocator>
+    explicit rank_select(
+        const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+    {
+        build(bits);
+    }
+
+    /**
+     * @brief   Recomputes the whole index from @p bits
+     */
+    template<class Allocator>
+    void build(const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+    {
+        build(bits.blocks(), bits.size());
+    }
+
+    /**
+     * @brief   Updates the index after the bits in [@p first, @p last) of
+     *          @p bits were modified
+     *
+     * Only the superblocks covering the range are recomputed, the following
+     * ones are shifted by the difference of set bits. If the size of the
+     * bitset changed, everything after @p first is recomputed.
+     *
+     * @param bits  Bitset the index was built from, after its modification
+     */
+    template<class Allocator>
+    void update(const basic_dynamic_bitset<std::uint64_t, Allocator>& bits,
+                std::size_t                                          first,
+                std::size_t                                          last)
+    {
+        update(bits.blocks(), bits.size(), first, last);
+    }
+
+    /**
+     * @brief   Returns the number of set bits in [0, @p pos)
+     *
+     * @throws std::out_of_range Thrown if @p pos is greater than size()
+     */
+    std::size_t rank(std::size_t pos) const;
+
+    /**
+     * @brief   Returns the number of unset bits in [0, @p pos)
+     *
+     * @throws std::out_of_range Thrown if @p pos is greater than size()
+     */
+    std::size_t rank0(std::size_t pos) const { return pos - rank(pos); }
+
+    /**
+     * @brief   Returns the position of the set bit of rank @p k, counting
+     *          from 0, or npos if the bitset has @p k set bits or less
+     */
+    std::size_t select(std::size_t k) const noexcept;
+
+    /**
+     * @brief   Returns the number of set bits of the bitset
+     */
+    std::size_t count() const noexcept
+    {
+        return counts_.empty() ? 0 : counts_[counts_.size() - 2];
+    }
+
+    /**
+     * @brief   Returns the size of the indexed bitset, in bits
+     */
+    std::size_t size() const noexcept { return bit_size_; }
+
+    /**
+     * @brief   Returns the number of bytes used by the index
+     */
+    std::size_t memory_usage() const noexcept
+    {
+        return counts_.size() * sizeof(std::uint64_t) +
+               samples_.size() * sizeof(std::size_t);
+    }
+
+private:
+    void build(const std::uint64_t* blocks, std::size_t bit_size);
+
+    void update(const std::uint64_t* blocks,
+                std::size_t          bit_size,
+                std::size_t          first,
+                std::size_t          last);
+
+    /**
+     * @brief   Recomputes the superblocks in [@p first, @p last), knowing
+     *          that @p total bits are set before @p first
+     *
+     * @return  The number of set bits before @p last
+     */
+    std::uint64_t count_superblocks(std::size_t   first,
+                                    std::size_t   last,
+                                    std::uint64_t total) noexcept;
+
+    void sample();
+
+    std::size_t superblock_count() const noexcept
+    {
+        return counts_.size() / 2 - 1;
+    }
+
+    const std::uint64_t* blocks_ {nullptr};
+    std::size_t          bit_size_ {0};
+
+    // 2 words per superblock : the set bits before the superblock, and the
+    // packed counts of its words. A last superblock holds the total
+    std::vector<std::uint64_t> counts_;
+
+    // Superblock holding the set bit of rank i * select_sample
+    std::vector<std::size_t> samples_;
+};
+}    // namespace corgi::binary
@@ -0,0 +1,427 @@
+#pragma once
+
+#include <corgi/binary/dynamic_bitset.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace corgi::binary
+{
+namespace detail
+{
+/**
+ * @brief   Set bits of a 65536 bits chunk of a roaring_bitmap
+ *
+ * Depending on its kind, the container stores its bits as :
+ * - array  : the sorted positions of the set bits in values
+ * - bitmap : 1024 words of 64 bits in words
+ * - run    : pairs of (first, last) positions of the runs of set bits in
+ *            values, sorted and never adjacent
+ *
+ * A container is never empty.
+ */
+struct roaring_container
+{
+    enum class kind : std::uint8_t
+    {
+        array,
+        bitmap,
+        run
+    };
+
+    /**
+     * @brief   Bits covered by a container
+     */
+    static constexpr std::size_t chunk_bits = 65536;
+
+    /**
+     * @brief   Words of a bitmap container
+     */
+    static constexpr std::size_t bitmap_words = chunk_bits / 64;
+
+    /**
+     * @brief   Maximum number of values of an array container. Past that,
+     *          the array takes more memory than a bitmap
+     */
+    static constexpr std::size_t array_max = 4096;
+
+    kind                       type {kind::array};
+    std::uint32_t              cardinality {0};
+    std::vector<std::uint16_t> values;
+    std::vector<std::uint64_t> words;
+};
+
+/**
+ * @brief   Set operations between the containers of 2 roaring_bitmap
+ */
+enum class roaring_operation
+{
+    and_op,
+    or_op,
+    xor_op,
+    andnot_op
+};
+}    // namespace detail
+
+/**
+ * @brief   Compressed set of bit positions, for sparse bitsets or bitsets
+ *          made of long runs
+ *
+ * Follows the Roaring bitmap layout (Chambi, Lemire et al.) : positions are
+ * split into chunks of 65536 bits, and only the chunks holding set bits are
+ * stored, each one in the smallest of 3 containers. Chunks with up to 4096
+ * set bits are sorted arrays of 16 bits values, denser chunks are plain
+ * bitmaps, and chunks made of few long runs are lists of intervals.
+ *
+ * Set operations work chunk by chunk and pick the cheapest algorithm for
+ * each pair of containers : merging arrays, probing a bitmap with the values
+ * of an array, the SIMD block kernels between bitmaps, or merging intervals
+ * between runs.
+ *
+ * Positions go from 0 to npos - 1, npos being the end of the iterators.
+ *
+ * Runs are only created when converting from a dynamic_bitset, by
+ * add_range(), and by run_optimize().
+ *
+ * @code
+ * roaring_bitmap ids {3, 70000, 1 << 30};
+ * ids.add_range(100, 200000);
+ * for(auto pos : ids & other)
+ *     visit(pos);
+ * @endcode
+ */
+class roaring_bitmap
+{
+public:
+    using value_type = std::size_t;
+    using size_type  = std::size_t;
+
+    class const_iterator;
+
+    /**
+     * @brief   Value returned by the find functions when no bit was found
+     */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief   Constructs an empty bitmap
+     */
+    roaring_bitmap() noexcept = default;
+
+    /**
+     * @brief   Constructs a bitmap holding the positions of @p positions
+     */
+    roaring_bitmap(std::initializer_list<std::size_t> positions);
+
+    /**
+     * @brief   Constructs a bitmap holding the set bits of @p bits
+     */
+    template<class Allocator>
+    explicit roaring_bitmap(
+        const basic_dynamic_bitset<std::uint64_t, Allocator>& bits)
+    {
+        assign(bits.blocks(), bits.block_size());
+    }
+
+    /**
+     * @brief   Returns a dynamic_bitset of @p size bits, whose set bits are
+     *          the positions of the bitmap
+     *
+     * @throws std::out_of_range Thrown if a position is greater or equal to
+     * @p size
+     */
+    template<class Allocator = std::allocator<std::uint64_t>>
+    basic_dynamic_bitset<std::uint64_t, Allocator>
+    to_bitset(std::size_t size, const Allocator& alloc = Allocator()) const
+    {
+        basic_dynamic_bitset<std::uint64_t, Allocator> bits(size, false,
+                                                            alloc);
+        copy_to(bits.blocks(), size);
+        return bits;
+    }
+
+    /**
+     * @brief   Returns a dynamic_bitset just large enough to hold the last
+     *          position of the bitmap
+     */
+    dynamic_bitset to_bitset() const
+    {
+        return to_bitset(empty() ? 0 : find_last() + 1);
+    }
+
+    /**
+     * @brief   Adds @p pos to the bitmap
+     *
+     * @throws std::out_of_range Thrown if @p pos is npos, which marks the end
+     * of the iterators
+     */
+    void add(std::size_t pos);
+
+    /**
+     * @brief   Adds every position in [@p first, @p last)
+     *
+     * Since @p last is excluded, npos is never added.
+     *
+     * @throws std::invalid_argument Thrown if @p first is greater than
+     * @p last
+     */
+    void add_range(std::size_t first, std::size_t last);
+
+    /**
+     * @brief   Removes @p pos from the bitmap
+     */
+    void remove(std::size_t pos);
+
+    /**
+     * @brief   Returns true if @p pos is in the bitmap
+     */
+    bool contains(std::size_t pos) const noexcept;
+
+    /**
+     * @brief   Removes every position
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief   Returns true if the bitmap holds no position
+     */
+    bool empty() const noexcept { return containers_.empty(); }
+
+    /**
+     * @brief   Returns the number of positions in the bitmap
+     */
+    std::size_t count() const noexcept;
+
+    /**
+     * @brief   Returns the smallest position, or npos if the bitmap is empty
+     */
+    std::size_t find_first() const noexcept;
+
+    /**
+     * @brief   Returns the largest position, or npos if the bitmap is empty
+     */
+    std::size_t find_last() const noexcept;
+
+    /**
+     * @brief   Converts the containers to runs of set bits when it saves
+     *          memory
+     *
+     * @retval  True if at least one container was converted
+     */
+    bool run_optimize();
+
+    /**
+     * @brief   Releases the memory the containers don't use
+     */
+    void shrink_to_fit();
+
+    /**
+     * @brief   Returns the number of bytes used by the bitmap
+     */
+    std::size_t memory_usage() const noexcept;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    /**
+     * @brief   Returns true if both bitmaps hold the same positions, no
+     *          matter how they are stored
+     */
+    bool operator==(const roaring_bitmap& other) const;
+
+    roaring_bitmap& operator&=(const roaring_bitmap& other);
+    roaring_bitmap& operator|=(const roaring_bitmap& other);
+    roaring_bitmap& operator^=(const roaring_bitmap& other);
+
+    /**
+     * @brief   Removes the positions of @p other (set difference)
+     */
+    roaring_bitmap& operator-=(const roaring_bitmap& other);
+
+    friend roaring_bitmap operator&(const roaring_bitmap& lhs,
+                                    const roaring_bitmap& rhs);
+    friend roaring_bitmap operator|(const roaring_bitmap& lhs,
+                                    const roaring_bitmap& rhs);
+    friend roaring_bitmap operator^(const roaring_bitmap& lhs,
+                                    const roaring_bitmap& rhs);
+    friend roaring_bitmap operator-(const roaring_bitmap& lhs,
+                                    const roaring_bitmap& rhs);
+
+private:
+    using container = detail::roaring_container;
+
+    static roaring_bitmap combine(const roaring_bitmap&     lhs,
+                                  const roaring_bitmap&     rhs,
+                                  detail::roaring_operation op);
+
+    /**
+     * @brief   Fills the bitmap with the set bits of @p block_count blocks
+     */
+    void assign(const std::uint64_t* blocks, std::size_t block_count);
+
+    /**
+     * @brief   Sets the bits of the positions inside @p blocks, which hold
+     *          @p bit_size bits set to 0
+     */
+    void copy_to(std::uint64_t* blocks, std::size_t bit_size) const;
+
+    /**
+     * @brief   Returns the index of the container of @p key, or the index
+     *          where it should be inserted
+     */
+    std::size_t lower_bound(std::size_t key) const noexcept;
+
+    /**
+     * @brief   Chunk index (position / 65536) of every container
+     */
+    std::vector<std::size_t> keys_;
+    std::vector<container>   containers_;
+};
+
+/**
+ * @brief   Forward iterator over the positions of a roaring_bitmap, in
+ *          increasing order
+ *
+ * Invalidated by any modification of the bitmap.
+ */
+class roaring_bitmap::const_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::size_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::size_t*;
+    using reference         = std::size_t;
+
+    /**
+     * @brief   Constructs an end iterator
+     */
+    const_iterator() noexcept = default;
+
+    reference operator*() const noexcept { return position_; }
+
+    const_iterator& operator++() noexcept
+    {
+        const auto& c = bitmap_->containers_[container_];
+
+        switch(c.type)
+        {
+            case container::kind::array:
+                if(++index_ < c.values.size())
+                {
+                    position_ = base_ + c.values[index_];
+                    return *this;
+                }
+                break;
+
+            case container::kind::bitmap:
+                // Like set_bit_iterator, the visited bits are cleared from
+                // the copy of the current word
+                word_ &= word_ - 1;
+                while(word_ == 0 && ++index_ < container::bitmap_words)
+                    word_ = c.words[index_];
+                if(word_ != 0)
+                {
+                    position_ =
+                        base_ + index_ * 64 +
+                        static_cast<std::size_t>(std::countr_zero(word_));
+                    return *this;
+                }
+                break;
+
+            case container::kind::run:
+                if(position_ - base_ < c.values[2 * index_ + 1])
+                {
+                    position_++;
+                    return *this;
+                }
+                if(++index_ < c.values.size() / 2)
+                {
+                    position_ = base_ + c.values[2 * index_];
+                    return *this;
+                }
+                break;
+        }
+
+        load_container(container_ + 1);
+        return *this;
+    }
+
+    const_iterator operator++(int) noexcept
+    {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    friend bool operator==(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept
+    {
+        return lhs.position_ == rhs.position_;
+    }
+
+private:
+    friend class roaring_bitmap;
+
+    explicit const_iterator(const roaring_bitmap& bitmap) noexcept
+        : bitmap_(&bitmap)
+    {
+        load_container(0);
+    }
+
+    void load_container(std::size_t index) noexcept
+    {
+        container_ = index;
+        index_     = 0;
+
+        if(index >= bitmap_->containers_.size())
+        {
+            position_ = end_position;
+            return;
+        }
+
+        const auto& c = bitmap_->containers_[index];
+        base_         = bitmap_->keys_[index] * container::chunk_bits;
+
+        if(c.type == container::kind::bitmap)
+        {
+            // Containers are never empty, so a set bit exists
+            while(c.words[index_] == 0)
+                index_++;
+            word_     = c.words[index_];
+            position_ = base_ + index_ * 64 +
+                        static_cast<std::size_t>(std::countr_zero(word_));
+        }
+        else
+        {
+            position_ = base_ + c.values[0];
+        }
+    }
+
+    static constexpr std::size_t end_position = static_cast<std::size_t>(-1);
+
+    const roaring_bitmap* bitmap_ {nullptr};
+    std::size_t           container_ {0};
+
+    // Value index for arrays, word index for bitmaps, run index for runs
+    std::size_t   index_ {0};
+    std::uint64_t word_ {0};
+    std::size_t   base_ {0};
+    std::size_t   position_ {end_position};
+};
+
+inline roaring_bitmap::const_iterator roaring_bitmap::begin() const noexcept
+{
+    return const_iterator(*this);
+}
+
+inline roaring_bitmap::const_iterator roaring_bitmap::end() const noexcept
+{
+    return const_iterator();
+}
+}    // namespace corgi::binary
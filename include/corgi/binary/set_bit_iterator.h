@@ -0,0 +1,140 @@
+#pragma once
+
+#include <corgi/binary/detail/block_ops.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace corgi::binary
+{
+
+/**
+ * @brief   Forward iterator over the positions of the set bits of an array
+ *          of blocks
+ *
+ * The iterator keeps a copy of the block it's currently in and clears the
+ * bits it already visited, so moving to the next set bit is a tzcnt in the
+ * common case. Empty blocks are skipped without looking at their bits.
+ */
+template<class Block = std::uint64_t>
+class set_bit_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::size_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::size_t*;
+    using reference         = std::size_t;
+
+    /**
+     * @brief   Constructs an end iterator
+     */
+    set_bit_iterator() noexcept = default;
+
+    /**
+     * @brief   Constructs an iterator pointing to the first set bit of
+     *          @p blocks
+     *
+     * @param blocks        Blocks the iterator walks through. Bits past the
+     *                      last valid bit must be 0
+     * @param block_count   Number of blocks in @p blocks
+     */
+    set_bit_iterator(const Block* blocks, std::size_t block_count) noexcept
+        : blocks_(blocks)
+        , block_count_(block_count)
+    {
+        load_block(detail::find_nonzero_block(blocks_, 0, block_count_));
+    }
+
+    reference operator*() const noexcept { return position_; }
+
+    set_bit_iterator& operator++() noexcept
+    {
+        // Clears the lowest set bit, which is the one we're on
+        current_ &= current_ - 1;
+
+        if(current_ != 0)
+        {
+            position_ = block_index_ * detail::block_bits<Block> +
+                        static_cast<std::size_t>(std::countr_zero(current_));
+            return *this;
+        }
+
+        // The next block is often not empty on dense sets, so we avoid the
+        // call to the kernel when we can
+        auto next = block_index_ + 1;
+        if(next < block_count_ && blocks_[next] == 0)
+            next = detail::find_nonzero_block(blocks_, next, block_count_);
+
+        load_block(next);
+        return *this;
+    }
+
+    set_bit_iterator operator++(int) noexcept
+    {
+        auto copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    friend bool operator==(const set_bit_iterator& lhs,
+                           const set_bit_iterator& rhs) noexcept
+    {
+        return lhs.position_ == rhs.position_;
+    }
+
+private:
+    void load_block(std::size_t index) noexcept
+    {
+        if(index >= block_count_)
+        {
+            position_ = end_position;
+            return;
+        }
+        block_index_ = index;
+        current_     = blocks_[index];
+        position_    = index * detail::block_bits<Block> +
+                    static_cast<std::size_t>(std::countr_zero(current_));
+    }
+
+    static constexpr std::size_t end_position = static_cast<std::size_t>(-1);
+
+    const Block* blocks_ {nullptr};
+    std::size_t  block_count_ {0};
+    std::size_t  block_index_ {0};
+    Block        current_ {0};
+    std::size_t  position_ {end_position};
+};
+
+/**
+ * @brief   Range of the positions of the set bits of a bitset, usable in a
+ *          range based for loop
+ */
+template<class Block = std::uint64_t>
+class set_bit_range
+{
+public:
+    set_bit_range(const Block* blocks, std::size_t block_count) noexcept
+        : blocks_(blocks)
+        , block_count_(block_count)
+    {
+    }
+
+    set_bit_iterator<Block> begin() const noexcept
+    {
+        return set_bit_iterator<Block>(blocks_, block_count_);
+    }
+
+    set_bit_iterator<Block> end() const noexcept
+    {
+        return set_bit_iterator<Block>();
+    }
+
+private:
+    const Block* blocks_;
+    std::size_t  block_count_;
+};
+
+}    // namespace corgi::binary
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace corgi::binary
+{
+/**
+ * @brief   Instruction sets the bulk operations of the library can be
+ *          dispatched to
+ *
+ * The best level supported by the CPU is picked the first time a bulk
+ * operation runs. Levels are ordered, a level implies the ones before it.
+ */
+enum class simd_level
+{
+    scalar,
+    avx2,
+    avx512
+};
+
+/**
+ * @brief   Returns the best simd_level supported by the current CPU
+ */
+simd_level detected_simd_level() noexcept;
+
+/**
+ * @brief   Returns the simd_level currently used by the bulk operations
+ */
+simd_level active_simd_level() noexcept;
+
+/**
+ * @brief   Forces the bulk operations to use @p level
+ *
+ * Mostly useful to test or benchmark the different code paths
+ *
+ * @throws std::invalid_argument Thrown if the CPU doesn't support @p level
+ */
+void set_simd_level(simd_level level);
+
+}    // namespace corgi::binary
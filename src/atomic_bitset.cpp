@@ -0,0 +1,89 @@
+#include <corgi/binary/atomic_bitset.h>
+
+#include <bit>
+#include <utility>
+
+namespace corgi::binary
+{
+atomic_bitset::atomic_bitset(std::size_t size)
+    // The atomics are value initialized to 0
+    : words_(std::make_unique<word_type[]>(detail::block_count<std::uint64_t>(
+          size)))
+    , size_(size)
+{
+}
+
+atomic_bitset::atomic_bitset(atomic_bitset&& other) noexcept
+    : words_(std::move(other.words_))
+    , size_(std::exchange(other.size_, 0))
+{
+}
+
+atomic_bitset& atomic_bitset::operator=(atomic_bitset&& other) noexcept
+{
+    words_ = std::move(other.words_);
+    size_  = std::exchange(other.size_, 0);
+    return *this;
+}
+
+void atomic_bitset::merge(const atomic_bitset& other, std::memory_order order)
+{
+    check_same_size(other.size());
+
+    for(std::size_t i = 0; i < block_size(); i++)
+    {
+        const auto bits = other.words_[i].load(load_order(order));
+        if(bits != 0 && (words_[i].load(load_order(order)) & bits) != bits)
+            words_[i].fetch_or(bits, order);
+    }
+}
+
+void atomic_bitset::merge(const std::uint64_t* blocks,
+                          std::memory_order    order) noexcept
+{
+    for(std::size_t i = 0; i < block_size(); i++)
+    {
+        // Most words of a sparse bitset are empty, and rereading a word is
+        // cheaper than writing to it
+        const auto bits = blocks[i];
+        if(bits != 0 && (words_[i].load(load_order(order)) & bits) != bits)
+            words_[i].fetch_or(bits, order);
+    }
+}
+
+std::size_t atomic_bitset::count(std::memory_order order) const noexcept
+{
+    std::size_t result = 0;
+    for(std::size_t i = 0; i < block_size(); i++)
+        result += static_cast<std::size_t>(
+            std::popcount(words_[i].load(load_order(order))));
+    return result;
+}
+
+void atomic_bitset::clear(std::memory_order order) noexcept
+{
+    // Stores can't have an acquire part
+    const auto store_order = order == std::memory_order_acq_rel ||
+                                     order == std::memory_order_acquire ||
+                                     order == std::memory_order_consume
+                                 ? std::memory_order_release
+                                 : order;
+
+    for(std::size_t i = 0; i < block_size(); i++)
+        words_[i].store(0, store_order);
+}
+
+void atomic_bitset::copy_to(std::uint64_t*    blocks,
+                            std::memory_order order) const noexcept
+{
+    for(std::size_t i = 0; i < block_size(); i++)
+        blocks[i] = words_[i].load(load_order(order));
+}
+
+void atomic_bitset::check_same_size(std::size_t size) const
+{
+    if(size != size_)
+        throw std::invalid_argument(
+            "Argument other doesn't have the same size as the bitset");
+}
+}    // namespace corgi::binary
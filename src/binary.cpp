@@ -1,7 +1,7 @@
 #include <corgi/binary/binary.h>
+#include <corgi/binary/bit_reader.h>
 
 #include <cassert>
-#include <cmath>
 #include <stdexcept>
 
 namespace corgi::binary
@@ -34,53 +34,11 @@ T bits_to_type(std::size_t    pos,
     if(pos + len < 0 || pos + len > size * 8)
         throw std::invalid_argument("Argument pos is out of bounds ");
 
-    // Stores the final result
-    T result = 0;
-
-    // Stores how many bits have been currently read so far
-    std::size_t current_bits_done = 0;
-
-    // As long as there's some bits to read, the loop goes on
-    while(len != 0)
-    {
-        // We get back the byte we're working on and the offset of our first bit
-        // inside the byte
-        const std::size_t byte_offset        = pos / 8;
-        const std::size_t bit_offset_in_byte = pos % 8;
-
-        // We count how many bits we read from the current byte
-        std::size_t readable_bits = 8 - bit_offset_in_byte;
-        std::size_t bits_to_read  = len;
-
-        // If we have more bits to read than we have on the current byte
-        if(len > readable_bits)
-        {
-            // We read what we can
-            len -= readable_bits;
-            bits_to_read = readable_bits;
-        }
-        else
-            len = 0;
-
-        // We create a binary value that correspond to the number of bit we're
-        // reading from the current byte. This variable will be used as a mask
-        // to get only the bits we're interested in the current byte
-        T mask = static_cast<T>(std::pow(2, bits_to_read) - 1);
-
-        // We shift it so it's starts at the right position
-        mask <<= bit_offset_in_byte;
-
-        // We AND the mask and the content of the byte to only get the bits we
-        // want
-        mask &= src[byte_offset];
-
-        // We add the bits we recuperated to the result at the right position
-        result = result + ((mask >> (bit_offset_in_byte) << current_bits_done));
-
-        pos += bits_to_read;
-        current_bits_done += bits_to_read;
-    }
-    return result;
+    // The reader jumps straight to the byte holding pos and loads the field
+    // with a single unaligned load
+    bit_reader reader({src, size});
+    reader.skip(pos);
+    return static_cast<T>(reader.read(len));
 }
 
 int bits_to_int(std::size_t    pos,
@@ -0,0 +1,13 @@
+#include <corgi/binary/bit_reader.h>
+
+namespace corgi::binary
+{
+void bit_reader::refill_tail() noexcept
+{
+    while(byte_pos_ < size_ && bit_count_ <= buffer_bits)
+    {
+        buffer_ |= std::uint64_t {data_[byte_pos_++]} << bit_count_;
+        bit_count_ += 8;
+    }
+}
+}    // namespace corgi::binary
@@ -0,0 +1,147 @@
+#include <corgi/binary/bit_writer.h>
+
+#include <algorithm>
+
+namespace corgi::binary
+{
+bit_writer::bit_writer(std::vector<unsigned char>& buffer)
+    : vector_(&buffer)
+    , vector_offset_(buffer.size())
+{
+    begin_ = out_ = end_ = buffer.data() + vector_offset_;
+}
+
+bit_writer::bit_writer(std::span<unsigned char> buffer) noexcept
+    : begin_(buffer.data())
+    , out_(buffer.data())
+    , end_(buffer.data() + buffer.size())
+{
+}
+
+bit_writer::bit_writer(std::ostream& stream, std::size_t buffer_size)
+    : stream_(&stream)
+    , stream_buffer_(std::max<std::size_t>(buffer_size, 8))
+{
+    begin_ = out_ = stream_buffer_.data();
+    end_          = begin_ + stream_buffer_.size();
+}
+
+bit_writer::~bit_writer()
+{
+    try
+    {
+        flush();
+    }
+    catch(...)
+    {
+    }
+}
+
+void bit_writer::flush()
+{
+    const auto bytes = (bit_count_ + 7) / 8;
+    if(bytes != 0)
+    {
+        if(static_cast<std::size_t>(end_ - out_) < bytes)
+            make_room(bytes);
+
+        std::memcpy(out_, &accumulator_, bytes);
+        out_ += bytes;
+        accumulator_ = 0;
+        bit_count_   = 0;
+    }
+
+    if(vector_ != nullptr)
+    {
+        // Drops the bytes reserved in advance by make_room
+        const auto written = static_cast<std::size_t>(out_ - begin_);
+        vector_->resize(vector_offset_ + written);
+        begin_ = vector_->data() + vector_offset_;
+        out_ = end_ = begin_ + written;
+    }
+    else if(stream_ != nullptr)
+    {
+        stream_->write(reinterpret_cast<const char*>(begin_), out_ - begin_);
+        flushed_ += static_cast<std::size_t>(out_ - begin_);
+        out_ = begin_;
+        stream_->flush();
+    }
+}
+
+void bit_writer::write(std::span<const std::uint64_t> values,
+                       std::size_t                    count)
+{
+    if(count > 64)
+        throw std::invalid_argument("Argument count is greater than 64");
+
+    if(count == 0)
+        return;
+
+    const auto mask = count == 64 ? ~std::uint64_t {0}
+                                  : (std::uint64_t {1} << count) - 1;
+
+    // Stores through out_ could alias the members, so the state is kept in
+    // locals and only written back when leaving the loop
+    auto accumulator = accumulator_;
+    auto bit_count   = bit_count_;
+    auto out         = out_;
+
+    for(auto value : values)
+    {
+        value &= mask;
+        accumulator |= value << bit_count;
+
+        if(bit_count + count < 64)
+        {
+            bit_count += count;
+            continue;
+        }
+
+        if(end_ - out < 8)
+        {
+            out_ = out;
+            make_room(8);
+            out = out_;
+        }
+
+        std::memcpy(out, &accumulator, sizeof(accumulator));
+        out += 8;
+
+        accumulator = bit_count == 0 ? 0 : value >> (64 - bit_count);
+        bit_count   = bit_count + count - 64;
+    }
+
+    accumulator_ = accumulator;
+    bit_count_   = bit_count;
+    out_         = out;
+}
+
+void bit_writer::make_room(std::size_t count)
+{
+    if(vector_ != nullptr)
+    {
+        // Grows geometrically, the extra bytes are trimmed by flush
+        const auto written = static_cast<std::size_t>(out_ - begin_);
+        const auto size    = vector_offset_ + written + count;
+        vector_->resize(std::max({size, vector_->size() * 2,
+                                  std::size_t {64}}));
+
+        begin_ = vector_->data() + vector_offset_;
+        out_   = begin_ + written;
+        end_   = vector_->data() + vector_->size();
+        return;
+    }
+
+    if(stream_ != nullptr)
+    {
+        // The staging buffer is always at least 8 bytes, emptying it is
+        // enough
+        stream_->write(reinterpret_cast<const char*>(begin_), out_ - begin_);
+        flushed_ += static_cast<std::size_t>(out_ - begin_);
+        out_ = begin_;
+        return;
+    }
+
+    throw std::length_error("Not enough room left in the buffer");
+}
+}    // namespace corgi::binary
@@ -0,0 +1,469 @@
+#include <corgi/binary/bitset_io.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ios>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace corgi::binary
+{
+namespace
+{
+static_assert(std::endian::native == std::endian::little,
+              "The bitset format is read and written in place, which "
+              "requires a little endian target");
+
+constexpr char magic[8] = {'C', 'O', 'R', 'G', 'I', 'B', 'I', 'T'};
+
+constexpr std::uint8_t little_endian = 1;
+
+// Payloads are read and written by chunks of that size, a multiple of the
+// 32 bytes stripes of the hash
+constexpr std::size_t chunk_size = 1 << 20;
+
+/**
+ * @brief   Streaming XXH64 (Yann Collet), hashing 8 bytes per multiply on 4
+ *          independent lanes
+ */
+class xxhash64_state
+{
+public:
+    explicit xxhash64_state(std::uint64_t seed) noexcept
+        : lanes_ {seed + prime1 + prime2, seed + prime2, seed, seed - prime1}
+        , seed_(seed)
+    {
+    }
+
+    void update(const unsigned char* data, std::size_t size) noexcept
+    {
+        if(size == 0)
+            return;
+
+        length_ += size;
+
+        // Completes the stripe started by the previous update
+        if(buffered_ != 0)
+        {
+            const auto count = std::min(size, sizeof(buffer_) - buffered_);
+            std::memcpy(buffer_ + buffered_, data, count);
+            buffered_ += count;
+            data += count;
+            size -= count;
+
+            if(buffered_ < sizeof(buffer_))
+                return;
+            stripe(buffer_);
+            buffered_ = 0;
+        }
+
+        for(; size >= sizeof(buffer_); size -= sizeof(buffer_))
+        {
+            stripe(data);
+            data += sizeof(buffer_);
+        }
+
+        std::memcpy(buffer_, data, size);
+        buffered_ = size;
+    }
+
+    std::uint64_t digest() const noexcept
+    {
+        std::uint64_t hash;
+        if(length_ >= sizeof(buffer_))
+        {
+            hash = std::rotl(lanes_[0], 1) + std::rotl(lanes_[1], 7) +
+                   std::rotl(lanes_[2], 12) + std::rotl(lanes_[3], 18);
+            for(const auto lane : lanes_)
+                hash = (hash ^ round(0, lane)) * prime1 + prime4;
+        }
+        else
+            hash = seed_ + prime5;
+
+        hash += length_;
+
+        const unsigned char* tail = buffer_;
+        auto                 size = buffered_;
+        for(; size >= 8; size -= 8, tail += 8)
+        {
+            hash ^= round(0, read<std::uint64_t>(tail));
+            hash = std::rotl(hash, 27) * prime1 + prime4;
+        }
+
+        if(size >= 4)
+        {
+            hash ^= read<std::uint32_t>(tail) * prime1;
+            hash = std::rotl(hash, 23) * prime2 + prime3;
+            size -= 4;
+            tail += 4;
+        }
+
+        for(; size != 0; size--, tail++)
+        {
+            hash ^= *tail * prime5;
+            hash = std::rotl(hash, 11) * prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87;
+    static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4F;
+    static constexpr std::uint64_t prime3 = 0x165667B19E3779F9;
+    static constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63;
+    static constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5;
+
+    template<class T>
+    static std::uint64_t read(const unsigned char* data) noexcept
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static std::uint64_t round(std::uint64_t lane, std::uint64_t input) noexcept
+    {
+        return std::rotl(lane + input * prime2, 31) * prime1;
+    }
+
+    void stripe(const unsigned char* data) noexcept
+    {
+        for(std::size_t i = 0; i < 4; i++)
+            lanes_[i] = round(lanes_[i], read<std::uint64_t>(data + 8 * i));
+    }
+
+    std::uint64_t lanes_[4];
+    std::uint64_t seed_;
+    std::uint64_t length_ {0};
+    unsigned char buffer_[32];
+    std::size_t   buffered_ {0};
+};
+
+std::uint64_t payload_bytes(std::uint64_t bit_size) noexcept
+{
+    // bit_size + 63 would wrap around for sizes close to the maximum
+    return (bit_size / 64 + (bit_size % 64 != 0)) * sizeof(std::uint64_t);
+}
+
+void encode_header(const bitset_file_header& header,
+                   unsigned char (&bytes)[bitset_file_header::size]) noexcept
+{
+    const std::uint32_t header_bytes = bitset_file_header::size;
+
+    std::memset(bytes, 0, sizeof(bytes));
+    std::memcpy(bytes, magic, sizeof(magic));
+    std::memcpy(bytes + 8, &header.version, 2);
+    std::memcpy(bytes + 10, &header.word_bytes, 1);
+    std::memcpy(bytes + 11, &header.endianness, 1);
+    std::memcpy(bytes + 12, &header_bytes, 4);
+    std::memcpy(bytes + 16, &header.bit_size, 8);
+    std::memcpy(bytes + 24, &header.payload_bytes, 8);
+    std::memcpy(bytes + 32, &header.checksum, 8);
+}
+
+bitset_file_header decode_header(const unsigned char* bytes)
+{
+    if(std::memcmp(bytes, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("Not a saved bitset");
+
+    bitset_file_header header;
+    std::uint32_t      header_bytes;
+    std::memcpy(&header.version, bytes + 8, 2);
+    std::memcpy(&header.word_bytes, bytes + 10, 1);
+    std::memcpy(&header.endianness, bytes + 11, 1);
+    std::memcpy(&header_bytes, bytes + 12, 4);
+    std::memcpy(&header.bit_size, bytes + 16, 8);
+    std::memcpy(&header.payload_bytes, bytes + 24, 8);
+    std::memcpy(&header.checksum, bytes + 32, 8);
+
+    if(header.version != bitset_file_header::current_version)
+        throw std::runtime_error("Unsupported bitset format version");
+
+    if(header_bytes != bitset_file_header::size ||
+       header.word_bytes != sizeof(std::uint64_t) ||
+       header.endianness != little_endian)
+        throw std::runtime_error("Unsupported bitset layout");
+
+    if(header.bit_size > std::numeric_limits<std::size_t>::max() ||
+       header.payload_bytes != payload_bytes(header.bit_size))
+        throw std::runtime_error("Corrupted bitset header");
+
+    return header;
+}
+
+/**
+ * @brief   Checks the hash of the payload, and that the bits past the size of
+ *          the bitset are 0
+ */
+void check_payload(const bitset_file_header& header,
+                   const std::uint64_t*      blocks,
+                   std::uint64_t             checksum)
+{
+    if(checksum != header.checksum)
+        throw std::runtime_error("Bitset checksum mismatch");
+
+    const auto used = header.bit_size % 64;
+    if(header.payload_bytes != 0 && used != 0 &&
+       (blocks[header.bit_size / 64] >> used) != 0)
+        throw std::runtime_error("Corrupted bitset payload");
+}
+
+bitset_file_header make_header(const std::uint64_t* blocks,
+                               std::size_t          bit_size) noexcept
+{
+    bitset_file_header header;
+    header.bit_size      = bit_size;
+    header.payload_bytes = payload_bytes(bit_size);
+    header.checksum      = detail::xxhash64(
+        {reinterpret_cast<const unsigned char*>(blocks),
+         static_cast<std::size_t>(header.payload_bytes)});
+    return header;
+}
+
+void write_bytes(std::ostream& stream, const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const char*>(data);
+    while(size != 0)
+    {
+        const auto count = std::min(size, chunk_size);
+        if(!stream.write(bytes, static_cast<std::streamsize>(count)))
+            throw std::ios_base::failure("Failed to write the bitset");
+        bytes += count;
+        size -= count;
+    }
+}
+
+void read_bytes(std::istream& stream, void* data, std::size_t size)
+{
+    if(!stream.read(static_cast<char*>(data),
+                    static_cast<std::streamsize>(size)))
+        throw std::ios_base::failure("Failed to read the bitset");
+}
+
+// read and write can do less than asked, and be interrupted by signals
+
+void write_bytes(int fd, const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    while(size != 0)
+    {
+        const auto count = std::min(size, chunk_size);
+#if defined(_WIN32)
+        const auto written =
+            ::_write(fd, bytes, static_cast<unsigned int>(count));
+#else
+        const auto written = ::write(fd, bytes, count);
+#endif
+        if(written < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(),
+                                    "Failed to write the bitset");
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+void read_bytes(int fd, void* data, std::size_t size)
+{
+    auto* bytes = static_cast<unsigned char*>(data);
+    while(size != 0)
+    {
+        const auto count = std::min(size, chunk_size);
+#if defined(_WIN32)
+        const auto got = ::_read(fd, bytes, static_cast<unsigned int>(count));
+#else
+        const auto got = ::read(fd, bytes, count);
+#endif
+        if(got < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(),
+                                    "Failed to read the bitset");
+        }
+        if(got == 0)
+            throw std::runtime_error("Truncated bitset file");
+
+        bytes += got;
+        size -= static_cast<std::size_t>(got);
+    }
+}
+
+template<class Stream>
+void save_to(const std::uint64_t* blocks, std::size_t bit_size, Stream& stream)
+{
+    const auto header = make_header(blocks, bit_size);
+
+    unsigned char bytes[bitset_file_header::size];
+    encode_header(header, bytes);
+    write_bytes(stream, bytes, sizeof(bytes));
+    write_bytes(stream, blocks, static_cast<std::size_t>(header.payload_bytes));
+}
+
+template<class Stream>
+bitset_file_header read_header_from(Stream& stream)
+{
+    unsigned char bytes[bitset_file_header::size];
+    read_bytes(stream, bytes, sizeof(bytes));
+    return decode_header(bytes);
+}
+
+// Sources whose size isn't known, like pipes and streams
+constexpr std::uint64_t unknown_size =
+    std::numeric_limits<std::uint64_t>::max();
+
+std::uint64_t available_bytes(std::istream&) noexcept
+{
+    return unknown_size;
+}
+
+/**
+ * @brief   Returns the number of bytes between the position of @p fd and the
+ *          end of the file, if it's a regular file
+ */
+std::uint64_t available_bytes(int fd) noexcept
+{
+#if defined(_WIN32)
+    struct _stat64 status;
+    if(::_fstat64(fd, &status) != 0 || (status.st_mode & _S_IFMT) != _S_IFREG)
+        return unknown_size;
+    const auto position = ::_lseeki64(fd, 0, SEEK_CUR);
+#else
+    struct stat status;
+    if(::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+        return unknown_size;
+    const auto position = ::lseek(fd, 0, SEEK_CUR);
+#endif
+    if(position < 0 || position > status.st_size)
+        return unknown_size;
+    return static_cast<std::uint64_t>(status.st_size - position);
+}
+
+template<class Stream>
+void read_payload_from(
+    const bitset_file_header&                          header,
+    const std::function<std::uint64_t*(std::size_t)>& grow,
+    Stream&                                            stream)
+{
+    const auto available = available_bytes(stream);
+    if(available != unknown_size && header.payload_bytes > available)
+        throw std::runtime_error("Truncated bitset file");
+
+    const auto     size   = static_cast<std::size_t>(header.payload_bytes);
+    std::uint64_t* blocks = nullptr;
+    if(available != unknown_size && size != 0)
+        blocks = grow(size);
+
+    // Each chunk is hashed right after being read, while it's in cache
+    xxhash64_state hash(0);
+    for(std::size_t offset = 0; offset < size; offset += chunk_size)
+    {
+        const auto count = std::min(chunk_size, size - offset);
+        if(available == unknown_size)
+            blocks = grow(offset + count);
+
+        auto* bytes = reinterpret_cast<unsigned char*>(blocks) + offset;
+        read_bytes(stream, bytes, count);
+        hash.update(bytes, count);
+    }
+    check_payload(header, blocks, hash.digest());
+}
+}    // namespace
+
+namespace detail
+{
+std::uint64_t xxhash64(std::span<const unsigned char> bytes,
+                       std::uint64_t                  seed) noexcept
+{
+    xxhash64_state hash(seed);
+    hash.update(bytes.data(), bytes.size());
+    return hash.digest();
+}
+
+void save_bitset(const std::uint64_t* blocks,
+                 std::size_t          bit_size,
+                 std::ostream&        stream)
+{
+    save_to(blocks, bit_size, stream);
+}
+
+void save_bitset(const std::uint64_t* blocks, std::size_t bit_size, int fd)
+{
+    save_to(blocks, bit_size, fd);
+}
+
+bitset_file_header read_bitset_header(std::istream& stream)
+{
+    return read_header_from(stream);
+}
+
+bitset_file_header read_bitset_header(int fd)
+{
+    return read_header_from(fd);
+}
+
+void read_bitset_payload(
+    const bitset_file_header&                          header,
+    const std::function<std::uint64_t*(std::size_t)>& grow,
+    std::istream&                                      stream)
+{
+    read_payload_from(header, grow, stream);
+}
+
+void read_bitset_payload(
+    const bitset_file_header&                          header,
+    const std::function<std::uint64_t*(std::size_t)>& grow,
+    int                                                fd)
+{
+    read_payload_from(header, grow, fd);
+}
+}    // namespace detail
+
+bitset_file_header read_bitset_header(std::span<const unsigned char> file)
+{
+    if(file.size() < bitset_file_header::size)
+        throw std::runtime_error("Truncated bitset file");
+    return decode_header(file.data());
+}
+
+const_bit_span view_bitset_file(std::span<const unsigned char> file,
+                                bool verify_checksum)
+{
+    const auto header  = read_bitset_header(file);
+    const auto payload = file.subspan(bitset_file_header::size);
+
+    if(payload.size() < header.payload_bytes)
+        throw std::runtime_error("Truncated bitset file");
+
+    const auto bit_size = static_cast<std::size_t>(header.bit_size);
+    const auto bytes    = payload.first(
+        static_cast<std::size_t>(header.payload_bytes));
+
+    if(verify_checksum && detail::xxhash64(bytes) != header.checksum)
+        throw std::runtime_error("Bitset checksum mismatch");
+
+    return const_bit_span(bytes.data(), bit_size);
+}
+}    // namespace corgi::binary
@@ -0,0 +1,263 @@
+#include "simd_target.h"
+
+#include <corgi/binary/detail/block_ops.h>
+
+namespace corgi::binary::detail
+{
+namespace
+{
+// Each operation is described once for every instruction set, the loops
+// below are shared between operations
+
+struct and_op
+{
+    static std::uint64_t scalar(std::uint64_t a, std::uint64_t b)
+    {
+        return a & b;
+    }
+#if CORGI_BINARY_X86
+    CORGI_BINARY_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b)
+    {
+        return _mm256_and_si256(a, b);
+    }
+    CORGI_BINARY_TARGET_AVX512 static __m512i avx512(__m512i a, __m512i b)
+    {
+        return _mm512_and_si512(a, b);
+    }
+#endif
+};
+
+struct or_op
+{
+    static std::uint64_t scalar(std::uint64_t a, std::uint64_t b)
+    {
+        return a | b;
+    }
+#if CORGI_BINARY_X86
+    CORGI_BINARY_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b)
+    {
+        return _mm256_or_si256(a, b);
+    }
+    CORGI_BINARY_TARGET_AVX512 static __m512i avx512(__m512i a, __m512i b)
+    {
+        return _mm512_or_si512(a, b);
+    }
+#endif
+};
+
+struct xor_op
+{
+    static std::uint64_t scalar(std::uint64_t a, std::uint64_t b)
+    {
+        return a ^ b;
+    }
+#if CORGI_BINARY_X86
+    CORGI_BINARY_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b)
+    {
+        return _mm256_xor_si256(a, b);
+    }
+    CORGI_BINARY_TARGET_AVX512 static __m512i avx512(__m512i a, __m512i b)
+    {
+        return _mm512_xor_si512(a, b);
+    }
+#endif
+};
+
+struct andnot_op
+{
+    static std::uint64_t scalar(std::uint64_t a, std::uint64_t b)
+    {
+        return a & ~b;
+    }
+#if CORGI_BINARY_X86
+    // The intrinsics compute ~first & second
+    CORGI_BINARY_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b)
+    {
+        return _mm256_andnot_si256(b, a);
+    }
+    CORGI_BINARY_TARGET_AVX512 static __m512i avx512(__m512i a, __m512i b)
+    {
+        return _mm512_andnot_si512(b, a);
+    }
+#endif
+};
+
+// NOT is a XOR with a block where every bit is set
+struct not_op
+{
+    static std::uint64_t scalar(std::uint64_t a, std::uint64_t)
+    {
+        return ~a;
+    }
+#if CORGI_BINARY_X86
+    CORGI_BINARY_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i)
+    {
+        return _mm256_xor_si256(a, _mm256_set1_epi64x(-1));
+    }
+    CORGI_BINARY_TARGET_AVX512 static __m512i avx512(__m512i a, __m512i)
+    {
+        return _mm512_ternarylogic_epi64(a, a, a, 0x55);
+    }
+#endif
+};
+
+template<class Op>
+void scalar_kernel(std::uint64_t*       dst,
+                   const std::uint64_t* a,
+                   const std::uint64_t* b,
+                   std::size_t          count) noexcept
+{
+    for(std::size_t i = 0; i < count; i++)
+        dst[i] = Op::scalar(a[i], b[i]);
+}
+
+#if CORGI_BINARY_X86
+template<class Op>
+CORGI_BINARY_TARGET_AVX2 void avx2_kernel(std::uint64_t*       dst,
+                                          const std::uint64_t* a,
+                                          const std::uint64_t* b,
+                                          std::size_t          count) noexcept
+{
+    std::size_t i = 0;
+
+    // 4 registers per iteration keeps enough loads in flight to saturate
+    // the memory bandwidth
+    for(; i + 16 <= count; i += 16)
+    {
+        const auto* pa = reinterpret_cast<const __m256i*>(a + i);
+        const auto* pb = reinterpret_cast<const __m256i*>(b + i);
+        auto*       pd = reinterpret_cast<__m256i*>(dst + i);
+
+        const auto r0 = Op::avx2(_mm256_loadu_si256(pa + 0),
+                                 _mm256_loadu_si256(pb + 0));
+        const auto r1 = Op::avx2(_mm256_loadu_si256(pa + 1),
+                                 _mm256_loadu_si256(pb + 1));
+        const auto r2 = Op::avx2(_mm256_loadu_si256(pa + 2),
+                                 _mm256_loadu_si256(pb + 2));
+        const auto r3 = Op::avx2(_mm256_loadu_si256(pa + 3),
+                                 _mm256_loadu_si256(pb + 3));
+
+        _mm256_storeu_si256(pd + 0, r0);
+        _mm256_storeu_si256(pd + 1, r1);
+        _mm256_storeu_si256(pd + 2, r2);
+        _mm256_storeu_si256(pd + 3, r3);
+    }
+
+    for(; i + 4 <= count; i += 4)
+    {
+        const auto r = Op::avx2(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), r);
+    }
+
+    for(; i < count; i++)
+        dst[i] = Op::scalar(a[i], b[i]);
+}
+
+template<class Op>
+CORGI_BINARY_TARGET_AVX512 void avx512_kernel(std::uint64_t*       dst,
+                                              const std::uint64_t* a,
+                                              const std::uint64_t* b,
+                                              std::size_t count) noexcept
+{
+    std::size_t i = 0;
+
+    for(; i + 32 <= count; i += 32)
+    {
+        const auto r0 = Op::avx512(_mm512_loadu_si512(a + i),
+                                   _mm512_loadu_si512(b + i));
+        const auto r1 = Op::avx512(_mm512_loadu_si512(a + i + 8),
+                                   _mm512_loadu_si512(b + i + 8));
+        const auto r2 = Op::avx512(_mm512_loadu_si512(a + i + 16),
+                                   _mm512_loadu_si512(b + i + 16));
+        const auto r3 = Op::avx512(_mm512_loadu_si512(a + i + 24),
+                                   _mm512_loadu_si512(b + i + 24));
+
+        _mm512_storeu_si512(dst + i, r0);
+        _mm512_storeu_si512(dst + i + 8, r1);
+        _mm512_storeu_si512(dst + i + 16, r2);
+        _mm512_storeu_si512(dst + i + 24, r3);
+    }
+
+    for(; i + 8 <= count; i += 8)
+    {
+        _mm512_storeu_si512(dst + i, Op::avx512(_mm512_loadu_si512(a + i),
+                                                _mm512_loadu_si512(b + i)));
+    }
+
+    // Masked loads and stores take care of the last blocks
+    if(i < count)
+    {
+        const auto mask = static_cast<__mmask8>((1u << (count - i)) - 1);
+        const auto r    = Op::avx512(_mm512_maskz_loadu_epi64(mask, a + i),
+                                  _mm512_maskz_loadu_epi64(mask, b + i));
+        _mm512_mask_storeu_epi64(dst + i, mask, r);
+    }
+}
+#endif
+
+template<class Op>
+void dispatch(std::uint64_t*       dst,
+              const std::uint64_t* a,
+              const std::uint64_t* b,
+              std::size_t          count) noexcept
+{
+#if CORGI_BINARY_X86
+    switch(active_simd_level())
+    {
+        case simd_level::avx512:
+            avx512_kernel<Op>(dst, a, b, count);
+            return;
+        case simd_level::avx2:
+            avx2_kernel<Op>(dst, a, b, count);
+            return;
+        case simd_level::scalar:
+            break;
+    }
+#endif
+    scalar_kernel<Op>(dst, a, b, count);
+}
+}    // namespace
+
+void and_blocks(std::uint64_t*       dst,
+                const std::uint64_t* a,
+                const std::uint64_t* b,
+                std::size_t          count) noexcept
+{
+    dispatch<and_op>(dst, a, b, count);
+}
+
+void or_blocks(std::uint64_t*       dst,
+               const std::uint64_t* a,
+               const std::uint64_t* b,
+               std::size_t          count) noexcept
+{
+    dispatch<or_op>(dst, a, b, count);
+}
+
+void xor_blocks(std::uint64_t*       dst,
+                const std::uint64_t* a,
+                const std::uint64_t* b,
+                std::size_t          count) noexcept
+{
+    dispatch<xor_op>(dst, a, b, count);
+}
+
+void andnot_blocks(std::uint64_t*       dst,
+                   const std::uint64_t* a,
+                   const std::uint64_t* b,
+                   std::size_t          count) noexcept
+{
+    dispatch<andnot_op>(dst, a, b, count);
+}
+
+void not_blocks(std::uint64_t*       dst,
+                const std::uint64_t* a,
+                std::size_t          count) noexcept
+{
+    // The second operand is ignored by not_op
+    dispatch<not_op>(dst, a, a, count);
+}
+
+}    // namespace corgi::binary::detail
@@ -0,0 +1,101 @@
+#include "simd_target.h"
+
+#include <corgi/binary/detail/block_ops.h>
+
+namespace corgi::binary::detail
+{
+namespace
+{
+std::size_t scalar_find(const std::uint64_t* blocks,
+                        std::size_t          first,
+                        std::size_t          last) noexcept
+{
+    for(auto i = first; i < last; i++)
+    {
+        if(blocks[i] != 0)
+            return i;
+    }
+    return last;
+}
+
+std::size_t scalar_rfind(const std::uint64_t* blocks,
+                         std::size_t          first,
+                         std::size_t          last) noexcept
+{
+    for(auto i = last; i-- > first;)
+    {
+        if(blocks[i] != 0)
+            return i;
+    }
+    return last;
+}
+
+#if CORGI_BINARY_X86
+
+// Both kernels OR 4 vectors (16 blocks) together so a single test tells if a
+// whole cache line pair is empty, then let the scalar loop find the exact
+// block
+
+CORGI_BINARY_TARGET_AVX2 std::size_t avx2_find(const std::uint64_t* blocks,
+                                               std::size_t          first,
+                                               std::size_t last) noexcept
+{
+    auto i = first;
+    for(; i + 16 <= last; i += 16)
+    {
+        const auto* p = reinterpret_cast<const __m256i*>(blocks + i);
+        const auto  v = _mm256_or_si256(
+            _mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+            _mm256_or_si256(_mm256_loadu_si256(p + 2),
+                            _mm256_loadu_si256(p + 3)));
+        if(!_mm256_testz_si256(v, v))
+            return scalar_find(blocks, i, i + 16);
+    }
+    return scalar_find(blocks, i, last);
+}
+
+CORGI_BINARY_TARGET_AVX2 std::size_t avx2_rfind(const std::uint64_t* blocks,
+                                                std::size_t          first,
+                                                std::size_t last) noexcept
+{
+    auto i = last;
+    for(; i >= first + 16; i -= 16)
+    {
+        const auto* p = reinterpret_cast<const __m256i*>(blocks + i - 16);
+        const auto  v = _mm256_or_si256(
+            _mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+            _mm256_or_si256(_mm256_loadu_si256(p + 2),
+                            _mm256_loadu_si256(p + 3)));
+        if(!_mm256_testz_si256(v, v))
+            return scalar_rfind(blocks, i - 16, i);
+    }
+
+    const auto found = scalar_rfind(blocks, first, i);
+    return found == i ? last : found;
+}
+#endif
+}    // namespace
+
+std::size_t find_nonzero_block(const std::uint64_t* blocks,
+                               std::size_t          first,
+                               std::size_t          last) noexcept
+{
+#if CORGI_BINARY_X86
+    if(active_simd_level() != simd_level::scalar)
+        return avx2_find(blocks, first, last);
+#endif
+    return scalar_find(blocks, first, last);
+}
+
+std::size_t rfind_nonzero_block(const std::uint64_t* blocks,
+                                std::size_t          first,
+                                std::size_t          last) noexcept
+{
+#if CORGI_BINARY_X86
+    if(active_simd_level() != simd_level::scalar)
+        return avx2_rfind(blocks, first, last);
+#endif
+    return scalar_rfind(blocks, first, last);
+}
+
+}    // namespace corgi::binary::detail
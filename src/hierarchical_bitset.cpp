@@ -0,0 +1,176 @@
+#include <corgi/binary/hierarchical_bitset.h>
+
+#include <bit>
+#include <stdexcept>
+
+namespace corgi::binary
+{
+hierarchical_bitset::hierarchical_bitset(std::size_t size)
+    : size_(size)
+{
+    if(size == 0)
+        return;
+
+    // Every level has a bit per word of the level below, the last one
+    // fitting in a single word
+    auto words = detail::block_count<std::uint64_t>(size);
+    levels_.emplace_back(words, 0);
+    while(words > 1)
+    {
+        words = detail::block_count<std::uint64_t>(words);
+        levels_.emplace_back(words, 0);
+    }
+}
+
+bool hierarchical_bitset::test(std::size_t pos) const
+{
+    check_pos(pos);
+    return (levels_[0][pos / 64] >> (pos % 64) & 1) != 0;
+}
+
+void hierarchical_bitset::set(std::size_t pos, bool value)
+{
+    if(!value)
+    {
+        reset(pos);
+        return;
+    }
+
+    check_pos(pos);
+
+    // Going up stops at the first word that wasn't empty, since its summary
+    // bit is already set
+    for(auto& words : levels_)
+    {
+        auto&      word      = words[pos / 64];
+        const auto was_empty = word == 0;
+        word |= std::uint64_t {1} << (pos % 64);
+
+        if(!was_empty)
+            return;
+        pos /= 64;
+    }
+}
+
+void hierarchical_bitset::reset(std::size_t pos)
+{
+    check_pos(pos);
+
+    // Going up stops at the first word that doesn't become empty
+    for(auto& words : levels_)
+    {
+        auto& word = words[pos / 64];
+        word &= ~(std::uint64_t {1} << (pos % 64));
+
+        if(word != 0)
+            return;
+        pos /= 64;
+    }
+}
+
+void hierarchical_bitset::clear() noexcept
+{
+    for(auto& words : levels_)
+        std::fill(words.begin(), words.end(), 0);
+}
+
+std::size_t hierarchical_bitset::count() const noexcept
+{
+    if(levels_.empty())
+        return 0;
+    return detail::count_blocks(levels_[0].data(), levels_[0].size());
+}
+
+std::size_t hierarchical_bitset::find_next(std::size_t pos) const noexcept
+{
+    // npos + 1 wraps around to 0, which lets find_first reuse this function
+    auto first = pos + 1;
+    if(first >= size_)
+        return npos;
+
+    // On each level, looks at the rest of the current word, then moves to
+    // the bit following that word on the level above
+    for(std::size_t level = 0; level < levels_.size(); level++)
+    {
+        const auto& words = levels_[level];
+        const auto  index = first / 64;
+        if(index >= words.size())
+            return npos;
+
+        const auto word =
+            words[index] & ~detail::low_mask<std::uint64_t>(first % 64);
+        if(word != 0)
+            return descend_first(
+                level, index * 64 +
+                           static_cast<std::size_t>(std::countr_zero(word)));
+
+        first = index + 1;
+    }
+    return npos;
+}
+
+std::size_t hierarchical_bitset::find_prev(std::size_t pos) const noexcept
+{
+    if(pos == 0 || size_ == 0)
+        return npos;
+
+    auto last = std::min(pos, size_) - 1;
+
+    for(std::size_t level = 0; level < levels_.size(); level++)
+    {
+        const auto index = last / 64;
+        const auto word  = levels_[level][index] &
+                          detail::low_mask<std::uint64_t>(last % 64 + 1);
+        if(word != 0)
+            return descend_last(
+                level, index * 64 + 63 -
+                           static_cast<std::size_t>(std::countl_zero(word)));
+
+        if(index == 0)
+            return npos;
+        last = index - 1;
+    }
+    return npos;
+}
+
+void hierarchical_bitset::assign(const std::uint64_t* blocks)
+{
+    if(levels_.empty())
+        return;
+
+    std::copy(blocks, blocks + levels_[0].size(), levels_[0].begin());
+
+    for(std::size_t level = 1; level < levels_.size(); level++)
+    {
+        const auto& below = levels_[level - 1];
+        auto&       words = levels_[level];
+        for(std::size_t i = 0; i < below.size(); i++)
+            if(below[i] != 0)
+                words[i / 64] |= std::uint64_t {1} << (i % 64);
+    }
+}
+
+std::size_t hierarchical_bitset::descend_first(std::size_t level,
+                                               std::size_t pos) const noexcept
+{
+    while(level-- > 0)
+        pos = pos * 64 +
+              static_cast<std::size_t>(std::countr_zero(levels_[level][pos]));
+    return pos;
+}
+
+std::size_t hierarchical_bitset::descend_last(std::size_t level,
+                                              std::size_t pos) const noexcept
+{
+    while(level-- > 0)
+        pos = pos * 64 + 63 -
+              static_cast<std::size_t>(std::countl_zero(levels_[level][pos]));
+    return pos;
+}
+
+void hierarchical_bitset::check_pos(std::size_t pos) const
+{
+    if(pos >= size_)
+        throw std::out_of_range("Argument pos is out of range");
+}
+}    // namespace corgi::binary
@@ -0,0 +1,117 @@
+#include <corgi/binary/instrumentation.h>
+
+#include <mutex>
+
+namespace corgi::binary
+{
+namespace
+{
+/**
+ * @brief   Counters of a thread, linked to the ones of the other threads
+ */
+struct thread_slot
+{
+    thread_slot() noexcept;
+    ~thread_slot();
+
+    detail::thread_counters counters {};
+    thread_slot*            previous {nullptr};
+    thread_slot*            next {nullptr};
+};
+
+/**
+ * @brief   Slots of the running threads, plus what the exited threads
+ *          counted
+ */
+struct registry
+{
+    std::mutex                                       mutex;
+    thread_slot*                                     first {nullptr};
+    std::array<std::uint64_t, detail::counter_count> exited {};
+};
+
+registry& get_registry() noexcept
+{
+    // Never destroyed, threads can still exit while statics are destroyed
+    static auto* instance = new registry;
+    return *instance;
+}
+
+thread_slot::thread_slot() noexcept
+{
+    auto&           reg = get_registry();
+    std::lock_guard lock(reg.mutex);
+
+    next = reg.first;
+    if(next != nullptr)
+        next->previous = this;
+    reg.first = this;
+}
+
+thread_slot::~thread_slot()
+{
+    auto&           reg = get_registry();
+    std::lock_guard lock(reg.mutex);
+
+    for(std::size_t i = 0; i < detail::counter_count; i++)
+        reg.exited[i] += counters[i].load(std::memory_order_relaxed);
+
+    if(previous != nullptr)
+        previous->next = next;
+    else
+        reg.first = next;
+    if(next != nullptr)
+        next->previous = previous;
+}
+
+std::uint64_t
+value(const std::array<std::uint64_t, detail::counter_count>& sums,
+      detail::counter                                         c) noexcept
+{
+    return sums[static_cast<std::size_t>(c)];
+}
+}    // namespace
+
+namespace detail
+{
+thread_counters& local_counters() noexcept
+{
+    thread_local thread_slot slot;
+    return slot.counters;
+}
+}    // namespace detail
+
+instrumentation_snapshot read_instrumentation() noexcept
+{
+    if constexpr(!instrumentation_enabled)
+        return {};
+
+    auto&           reg = get_registry();
+    std::lock_guard lock(reg.mutex);
+
+    auto sums = reg.exited;
+    for(auto* slot = reg.first; slot != nullptr; slot = slot->next)
+        for(std::size_t i = 0; i < detail::counter_count; i++)
+            sums[i] += slot->counters[i].load(std::memory_order_relaxed);
+
+    using detail::counter;
+    return {value(sums, counter::reallocations),
+            value(sums, counter::bytes_allocated),
+            value(sums, counter::bytes_copied),
+            value(sums, counter::slices),
+            value(sums, counter::bit_operations),
+            value(sums, counter::word_operations),
+            value(sums, counter::exceptions)};
+}
+
+void reset_instrumentation() noexcept
+{
+    auto&           reg = get_registry();
+    std::lock_guard lock(reg.mutex);
+
+    reg.exited.fill(0);
+    for(auto* slot = reg.first; slot != nullptr; slot = slot->next)
+        for(auto& counter : slot->counters)
+            counter.store(0, std::memory_order_relaxed);
+}
+}    // namespace corgi::binary
@@ -0,0 +1,364 @@
+#include "simd_target.h"
+
+#include <corgi/binary/packing.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace corgi::binary
+{
+namespace
+{
+static_assert(std::endian::native == std::endian::little,
+              "The packing kernels require a little endian target");
+
+// Every kernel is instantiated for each width, so shifts and strides are
+// constants. @p off is the bit offset of the first integer inside src[0],
+// in [0, 8).
+
+using unpack_kernel = void (*)(const unsigned char*,
+                               std::size_t,
+                               std::size_t,
+                               std::uint32_t*) noexcept;
+
+using pack_kernel = void (*)(unsigned char*,
+                             std::size_t,
+                             std::size_t,
+                             const std::uint32_t*) noexcept;
+
+template<std::size_t Width>
+constexpr std::uint64_t width_mask = (std::uint64_t {1} << Width) - 1;
+
+template<std::size_t Width>
+void scalar_unpack(const unsigned char* src,
+                   std::size_t          off,
+                   std::size_t          count,
+                   std::uint32_t*       out) noexcept
+{
+    const auto bytes = (off + Width * count + 7) / 8;
+
+    // Integers whose 8 bytes load stays inside the packed bytes
+    const auto fast =
+        bytes >= 8
+            ? std::min(count, ((bytes - 8) * 8 + 7 - off) / Width + 1)
+            : 0;
+
+    std::size_t i = 0;
+    for(; i < fast; i++)
+    {
+        const auto    pos = off + i * Width;
+        std::uint64_t word;
+        std::memcpy(&word, src + pos / 8, sizeof(word));
+        out[i] = static_cast<std::uint32_t>((word >> (pos % 8)) &
+                                            width_mask<Width>);
+    }
+
+    for(; i < count; i++)
+    {
+        const auto    pos   = off + i * Width;
+        const auto    first = pos / 8;
+        std::uint64_t word  = 0;
+        std::memcpy(&word, src + first,
+                    std::min<std::size_t>(sizeof(word), bytes - first));
+        out[i] = static_cast<std::uint32_t>((word >> (pos % 8)) &
+                                            width_mask<Width>);
+    }
+}
+
+template<std::size_t Width>
+void scalar_pack(unsigned char*       dst,
+                 std::size_t          off,
+                 std::size_t          count,
+                 const std::uint32_t* in) noexcept
+{
+    // Keeps the bits located before the packed range in the first byte
+    std::uint64_t accumulator = dst[0] & ((1u << off) - 1);
+    std::size_t   bits        = off;
+    auto          out         = dst;
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        const auto value = in[i] & width_mask<Width>;
+        accumulator |= value << bits;
+        bits += Width;
+
+        if(bits >= 64)
+        {
+            std::memcpy(out, &accumulator, sizeof(accumulator));
+            out += 8;
+            bits -= 64;
+            accumulator = bits == 0 ? 0 : value >> (Width - bits);
+        }
+    }
+
+    // Whole bytes first, then the last byte keeps the bits located after
+    // the packed range
+    const auto whole = bits / 8;
+    std::memcpy(out, &accumulator, whole);
+
+    if(bits % 8 != 0)
+    {
+        const auto keep =
+            static_cast<unsigned char>(~((1u << (bits % 8)) - 1));
+        const auto last =
+            static_cast<unsigned char>(accumulator >> (whole * 8));
+        out[whole] =
+            static_cast<unsigned char>((out[whole] & keep) | (last & ~keep));
+    }
+}
+
+#if CORGI_BINARY_X86
+
+// The AVX2 kernels rely on a group of 8 integers being exactly Width bytes
+// long : every group starts at the same bit offset inside its first byte, so
+// the byte shuffles and shift counts are computed once per call.
+
+/**
+ * @brief   Loads 16 bytes from @p low in the low lane and 16 bytes from
+ *          @p high in the high lane
+ */
+CORGI_BINARY_TARGET_AVX2 inline __m256i load_lanes(const unsigned char* low,
+                                                   const unsigned char* high)
+{
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(low))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(high)), 1);
+}
+
+/**
+ * @brief   Widths up to 25 bits : every integer fits in the 4 bytes starting
+ *          at its first byte, so 8 integers are decoded in 32 bits lanes
+ */
+template<std::size_t Width>
+CORGI_BINARY_TARGET_AVX2 void avx2_unpack_narrow(const unsigned char* src,
+                                                 std::size_t          off,
+                                                 std::size_t          count,
+                                                 std::uint32_t* out) noexcept
+{
+    static_assert(Width <= 25);
+
+    const auto bytes = (off + Width * count + 7) / 8;
+
+    // Integers 0-3 come from the low 128 bits lane, 4-7 from the high one.
+    // Each lane is loaded from the byte its first integer starts in
+    std::size_t               lane_start[2];
+    alignas(32) unsigned char shuffle[32];
+    alignas(32) std::uint32_t shift[8];
+    for(std::size_t lane = 0; lane < 2; lane++)
+    {
+        lane_start[lane] = (off + 4 * lane * Width) / 8;
+        for(std::size_t j = 0; j < 4; j++)
+        {
+            const auto bit =
+                off + (4 * lane + j) * Width - 8 * lane_start[lane];
+            for(std::size_t k = 0; k < 4; k++)
+                shuffle[16 * lane + 4 * j + k] =
+                    static_cast<unsigned char>(bit / 8 + k);
+            shift[4 * lane + j] = static_cast<std::uint32_t>(bit % 8);
+        }
+    }
+
+    const auto shuffle_v =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(shuffle));
+    const auto shift_v =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(shift));
+    const auto mask_v =
+        _mm256_set1_epi32(static_cast<int>(width_mask<Width>));
+
+    // The high lane load must stay inside the packed bytes
+    const auto groups = count / 8;
+    const auto safe_groups =
+        bytes >= lane_start[1] + 16
+            ? std::min(groups, (bytes - lane_start[1] - 16) / Width + 1)
+            : 0;
+
+    for(std::size_t g = 0; g < safe_groups; g++)
+    {
+        const auto* base = src + g * Width;
+
+        auto v = load_lanes(base + lane_start[0], base + lane_start[1]);
+        v      = _mm256_shuffle_epi8(v, shuffle_v);
+        v      = _mm256_and_si256(_mm256_srlv_epi32(v, shift_v), mask_v);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + g * 8), v);
+    }
+
+    scalar_unpack<Width>(src + safe_groups * Width, off,
+                         count - safe_groups * 8, out + safe_groups * 8);
+}
+
+/**
+ * @brief   Widths from 26 to 32 bits : integers can span 5 bytes, so they
+ *          are decoded in 64 bits lanes, 2 integers per 128 bits lane
+ */
+template<std::size_t Width>
+CORGI_BINARY_TARGET_AVX2 void avx2_unpack_wide(const unsigned char* src,
+                                               std::size_t          off,
+                                               std::size_t          count,
+                                               std::uint32_t* out) noexcept
+{
+    static_assert(Width > 25 && Width <= 32);
+
+    const auto bytes = (off + Width * count + 7) / 8;
+
+    // Pairs 0 and 1 go in the first vector, 2 and 3 in the second
+    std::size_t               pair_start[4];
+    alignas(32) unsigned char shuffle[64];
+    alignas(32) std::uint64_t shift[8];
+    for(std::size_t pair = 0; pair < 4; pair++)
+    {
+        pair_start[pair] = (off + 2 * pair * Width) / 8;
+        for(std::size_t j = 0; j < 2; j++)
+        {
+            const auto bit =
+                off + (2 * pair + j) * Width - 8 * pair_start[pair];
+            for(std::size_t k = 0; k < 8; k++)
+                shuffle[16 * pair + 8 * j + k] =
+                    static_cast<unsigned char>(bit / 8 + k);
+            shift[2 * pair + j] = bit % 8;
+        }
+    }
+
+    const auto* shuffles = reinterpret_cast<const __m256i*>(shuffle);
+    const auto* shifts   = reinterpret_cast<const __m256i*>(shift);
+
+    const auto shuffle_a = _mm256_load_si256(shuffles);
+    const auto shuffle_b = _mm256_load_si256(shuffles + 1);
+    const auto shift_a   = _mm256_load_si256(shifts);
+    const auto shift_b   = _mm256_load_si256(shifts + 1);
+    const auto mask_v    = _mm256_set1_epi64x(
+        static_cast<long long>(width_mask<Width>));
+
+    // Moves the low half of every 64 bits lane to the low 128 bits
+    const auto compress = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+    const auto groups = count / 8;
+    const auto safe_groups =
+        bytes >= pair_start[3] + 16
+            ? std::min(groups, (bytes - pair_start[3] - 16) / Width + 1)
+            : 0;
+
+    for(std::size_t g = 0; g < safe_groups; g++)
+    {
+        const auto* base = src + g * Width;
+
+        auto a = load_lanes(base + pair_start[0], base + pair_start[1]);
+        auto b = load_lanes(base + pair_start[2], base + pair_start[3]);
+
+        a = _mm256_and_si256(
+            _mm256_srlv_epi64(_mm256_shuffle_epi8(a, shuffle_a), shift_a),
+            mask_v);
+        b = _mm256_and_si256(
+            _mm256_srlv_epi64(_mm256_shuffle_epi8(b, shuffle_b), shift_b),
+            mask_v);
+
+        const auto v = _mm256_permute2x128_si256(
+            _mm256_permutevar8x32_epi32(a, compress),
+            _mm256_permutevar8x32_epi32(b, compress), 0x20);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + g * 8), v);
+    }
+
+    scalar_unpack<Width>(src + safe_groups * Width, off,
+                         count - safe_groups * 8, out + safe_groups * 8);
+}
+
+template<std::size_t Width>
+CORGI_BINARY_TARGET_AVX2 void avx2_unpack(const unsigned char* src,
+                                          std::size_t          off,
+                                          std::size_t          count,
+                                          std::uint32_t*       out) noexcept
+{
+    if constexpr(Width <= 25)
+        avx2_unpack_narrow<Width>(src, off, count, out);
+    else
+        avx2_unpack_wide<Width>(src, off, count, out);
+}
+
+template<std::size_t... Widths>
+constexpr std::array<unpack_kernel, sizeof...(Widths)>
+make_avx2_unpack(std::index_sequence<Widths...>)
+{
+    return {&avx2_unpack<Widths + 1>...};
+}
+
+constexpr auto avx2_unpack_kernels =
+    make_avx2_unpack(std::make_index_sequence<32>());
+#endif
+
+template<std::size_t... Widths>
+constexpr std::array<unpack_kernel, sizeof...(Widths)>
+make_scalar_unpack(std::index_sequence<Widths...>)
+{
+    return {&scalar_unpack<Widths + 1>...};
+}
+
+template<std::size_t... Widths>
+constexpr std::array<pack_kernel, sizeof...(Widths)>
+make_scalar_pack(std::index_sequence<Widths...>)
+{
+    return {&scalar_pack<Widths + 1>...};
+}
+
+// Indexed by width - 1
+constexpr auto scalar_unpack_kernels =
+    make_scalar_unpack(std::make_index_sequence<32>());
+constexpr auto scalar_pack_kernels =
+    make_scalar_pack(std::make_index_sequence<32>());
+}    // namespace
+
+void unpack(const unsigned char* src,
+            std::size_t          bit_offset,
+            std::size_t          width,
+            std::size_t          count,
+            std::uint32_t*       out)
+{
+    if(width > 32)
+        throw std::invalid_argument("Argument width is greater than 32");
+
+    if(count == 0)
+        return;
+
+    if(width == 0)
+    {
+        std::fill(out, out + count, 0u);
+        return;
+    }
+
+    src += bit_offset / 8;
+    bit_offset %= 8;
+
+#if CORGI_BINARY_X86
+    if(active_simd_level() != simd_level::scalar)
+    {
+        avx2_unpack_kernels[width - 1](src, bit_offset, count, out);
+        return;
+    }
+#endif
+    scalar_unpack_kernels[width - 1](src, bit_offset, count, out);
+}
+
+void pack(unsigned char*       dst,
+          std::size_t          bit_offset,
+          std::size_t          width,
+          std::size_t          count,
+          const std::uint32_t* in)
+{
+    if(width > 32)
+        throw std::invalid_argument("Argument width is greater than 32");
+
+    if(count == 0 || width == 0)
+        return;
+
+    // Packing is bound by the dependency on the 64 bits register rather
+    // than by the instructions, the width specialized scalar loop is used
+    // on every CPU
+    scalar_pack_kernels[width - 1](dst + bit_offset / 8, bit_offset % 8,
+                                   count, in);
+}
+}    // namespace corgi::binary
@@ -0,0 +1,206 @@
+#include <corgi/binary/parallel.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace corgi::binary::detail
+{
+namespace
+{
+constexpr std::size_t cache_line = 64;
+
+/**
+ * @brief   Number of blocks in a cache line
+ */
+constexpr std::size_t line_blocks = cache_line / sizeof(std::uint64_t);
+
+/**
+ * @brief   Threads waiting for jobs, shared by every parallel operation
+ *
+ * A job is a number of tasks. The thread running the job takes tasks too,
+ * so a pool of n workers runs n + 1 tasks at once. Jobs coming from
+ * different threads are run one after the other.
+ */
+class thread_pool
+{
+public:
+    static thread_pool& instance()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    thread_pool(const thread_pool&)            = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for(auto& worker : workers_)
+            worker.join();
+    }
+
+    /**
+     * @brief   Calls @p task(i) for every i in [0, task_count), and returns
+     *          once they all returned
+     */
+    void run(std::size_t                             task_count,
+             const std::function<void(std::size_t)>& task)
+    {
+        std::lock_guard job_lock(job_mutex_);
+
+        {
+            std::lock_guard lock(mutex_);
+            task_       = &task;
+            task_count_ = task_count;
+            next_task_  = 0;
+            done_tasks_ = 0;
+            error_      = nullptr;
+            generation_++;
+        }
+        wake_.notify_all();
+
+        std::unique_lock lock(mutex_);
+        work(lock);
+        done_.wait(lock, [&] { return done_tasks_ == task_count_; });
+        task_ = nullptr;
+
+        if(error_)
+            std::rethrow_exception(error_);
+    }
+
+private:
+    thread_pool()
+    {
+        const auto hardware = std::max(1u, std::thread::hardware_concurrency());
+        workers_.reserve(hardware - 1);
+        for(unsigned i = 1; i < hardware; i++)
+            workers_.emplace_back([this] { worker_loop(); });
+    }
+
+    void worker_loop()
+    {
+        std::unique_lock lock(mutex_);
+        std::size_t      seen_generation = 0;
+        while(true)
+        {
+            wake_.wait(lock, [&]
+                       { return stopping_ || generation_ != seen_generation; });
+            if(stopping_)
+                return;
+            seen_generation = generation_;
+            work(lock);
+        }
+    }
+
+    /**
+     * @brief   Runs tasks of the current job until none is left
+     *
+     * @p lock is released while a task runs.
+     */
+    void work(std::unique_lock<std::mutex>& lock)
+    {
+        while(task_ != nullptr && next_task_ < task_count_)
+        {
+            const auto index = next_task_++;
+            const auto task  = task_;
+
+            lock.unlock();
+            std::exception_ptr error;
+            try
+            {
+                (*task)(index);
+            }
+            catch(...)
+            {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            if(error && !error_)
+                error_ = error;
+            if(++done_tasks_ == task_count_)
+                done_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+
+    // Serializes the jobs
+    std::mutex job_mutex_;
+
+    // Protects everything below
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    const std::function<void(std::size_t)>* task_ {nullptr};
+    std::size_t                             task_count_ {0};
+    std::size_t                             next_task_ {0};
+    std::size_t                             done_tasks_ {0};
+    std::size_t                             generation_ {0};
+    std::exception_ptr                      error_;
+    bool                                    stopping_ {false};
+};
+}    // namespace
+
+void parallel_for(
+    const parallel_policy&                                policy,
+    const std::uint64_t*                                  blocks,
+    std::size_t                                           block_count,
+    const std::function<void(std::size_t, std::size_t)>& function)
+{
+    const auto threads =
+        policy.thread_count != 0
+            ? policy.thread_count
+            : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    // The allocators only align the blocks on 16 bytes, so the lines start
+    // head blocks after the beginning of the array
+    const auto misalignment =
+        reinterpret_cast<std::uintptr_t>(blocks) % cache_line;
+    const auto head = std::min(
+        block_count,
+        (cache_line - misalignment) % cache_line / sizeof(std::uint64_t));
+
+    // Every thread gets at least a cache line
+    const auto lines = (block_count - head + line_blocks - 1) / line_blocks;
+    const auto task_count = std::min(threads, std::max<std::size_t>(1, lines));
+
+    if(block_count < policy.serial_threshold || task_count <= 1)
+    {
+        if(block_count != 0)
+            function(0, block_count);
+        return;
+    }
+
+    const auto lines_per_task = (lines + task_count - 1) / task_count;
+
+    // Range i ends on the line boundary head + i * lines_per_task lines, the
+    // first range taking the head too
+    const auto boundary = [&](std::size_t task)
+    {
+        return task == 0 ? 0
+                         : std::min(block_count,
+                                    head + task * lines_per_task * line_blocks);
+    };
+
+    thread_pool::instance().run(task_count,
+                                [&](std::size_t task)
+                                {
+                                    const auto first = boundary(task);
+                                    const auto last  = boundary(task + 1);
+                                    if(first < last)
+                                        function(first, last);
+                                });
+}
+}    // namespace corgi::binary::detail
@@ -0,0 +1,189 @@
+#include "simd_target.h"
+
+#include <corgi/binary/detail/block_ops.h>
+
+#include <bit>
+
+namespace corgi::binary::detail
+{
+namespace
+{
+std::size_t generic_count(const std::uint64_t* blocks,
+                          std::size_t          count) noexcept
+{
+    std::size_t result = 0;
+    for(std::size_t i = 0; i < count; i++)
+        result += static_cast<std::size_t>(std::popcount(blocks[i]));
+    return result;
+}
+
+#if CORGI_BINARY_X86
+
+// Same loop as generic_count, but compiled so std::popcount becomes a single
+// popcnt instruction
+CORGI_BINARY_TARGET_BMI std::size_t popcnt_count(const std::uint64_t* blocks,
+                                                 std::size_t count) noexcept
+{
+    std::size_t result = 0;
+    for(std::size_t i = 0; i < count; i++)
+        result += static_cast<std::size_t>(std::popcount(blocks[i]));
+    return result;
+}
+
+// Counts the bits of every byte with a nibble lookup table, then sums the
+// bytes of each 64 bits lane
+CORGI_BINARY_TARGET_AVX2 __m256i popcount256(__m256i v) noexcept
+{
+    const __m256i lookup =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+    const auto lo  = _mm256_and_si256(v, low_mask);
+    const auto hi  = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const auto cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                     _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+CORGI_BINARY_TARGET_AVX2 inline __m256i load256(const __m256i* data) noexcept
+{
+    return _mm256_loadu_si256(data);
+}
+
+// Carry save adder : adds 3 bits vectors, outputs the carry in @p h and the
+// sum in @p l
+CORGI_BINARY_TARGET_AVX2 inline void
+csa(__m256i& h, __m256i& l, __m256i a, __m256i b, __m256i c) noexcept
+{
+    const auto u = _mm256_xor_si256(a, b);
+    h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+    l = _mm256_xor_si256(u, c);
+}
+
+/**
+ * Harley-Seal population count (Mula, Kurz, Lemire). A tree of carry save
+ * adders reduces 16 vectors to a single one, so the expensive popcount256 is
+ * only done once every 16 vectors.
+ */
+CORGI_BINARY_TARGET_AVX2 std::size_t
+harley_seal_count(const std::uint64_t* blocks, std::size_t count) noexcept
+{
+    const auto* data    = reinterpret_cast<const __m256i*>(blocks);
+    const auto  vectors = count / 4;
+
+    __m256i total    = _mm256_setzero_si256();
+    __m256i ones     = _mm256_setzero_si256();
+    __m256i twos     = _mm256_setzero_si256();
+    __m256i fours    = _mm256_setzero_si256();
+    __m256i eights   = _mm256_setzero_si256();
+    __m256i sixteens = _mm256_setzero_si256();
+    __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+
+    std::size_t i = 0;
+    for(; i + 16 <= vectors; i += 16)
+    {
+        const auto* d = data + i;
+        csa(twos_a, ones, ones, load256(d + 0), load256(d + 1));
+        csa(twos_b, ones, ones, load256(d + 2), load256(d + 3));
+        csa(fours_a, twos, twos, twos_a, twos_b);
+        csa(twos_a, ones, ones, load256(d + 4), load256(d + 5));
+        csa(twos_b, ones, ones, load256(d + 6), load256(d + 7));
+        csa(fours_b, twos, twos, twos_a, twos_b);
+        csa(eights_a, fours, fours, fours_a, fours_b);
+        csa(twos_a, ones, ones, load256(d + 8), load256(d + 9));
+        csa(twos_b, ones, ones, load256(d + 10), load256(d + 11));
+        csa(fours_a, twos, twos, twos_a, twos_b);
+        csa(twos_a, ones, ones, load256(d + 12), load256(d + 13));
+        csa(twos_b, ones, ones, load256(d + 14), load256(d + 15));
+        csa(fours_b, twos, twos, twos_a, twos_b);
+        csa(eights_b, fours, fours, fours_a, fours_b);
+        csa(sixteens, eights, eights, eights_a, eights_b);
+
+        total = _mm256_add_epi64(total, popcount256(sixteens));
+    }
+
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total,
+                             _mm256_slli_epi64(popcount256(eights), 3));
+    total =
+        _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+    total = _mm256_add_epi64(total, popcount256(ones));
+
+    for(; i < vectors; i++)
+        total = _mm256_add_epi64(total, popcount256(load256(data + i)));
+
+    std::size_t result =
+        static_cast<std::size_t>(_mm256_extract_epi64(total, 0)) +
+        static_cast<std::size_t>(_mm256_extract_epi64(total, 1)) +
+        static_cast<std::size_t>(_mm256_extract_epi64(total, 2)) +
+        static_cast<std::size_t>(_mm256_extract_epi64(total, 3));
+
+    for(std::size_t j = vectors * 4; j < count; j++)
+        result += static_cast<std::size_t>(_mm_popcnt_u64(blocks[j]));
+
+    return result;
+}
+
+CORGI_BINARY_TARGET_AVX512_POPCNT std::size_t
+avx512_count(const std::uint64_t* blocks, std::size_t count) noexcept
+{
+    __m512i total0 = _mm512_setzero_si512();
+    __m512i total1 = _mm512_setzero_si512();
+
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        total0 = _mm512_add_epi64(
+            total0, _mm512_popcnt_epi64(_mm512_loadu_si512(blocks + i)));
+        total1 = _mm512_add_epi64(
+            total1, _mm512_popcnt_epi64(_mm512_loadu_si512(blocks + i + 8)));
+    }
+
+    for(; i < count; i += 8)
+    {
+        const auto remaining = count - i;
+        const auto mask      = static_cast<__mmask8>(
+            remaining >= 8 ? 0xff : (1u << remaining) - 1);
+        total0 = _mm512_add_epi64(
+            total0,
+            _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(mask, blocks + i)));
+    }
+
+    return static_cast<std::size_t>(
+        _mm512_reduce_add_epi64(_mm512_add_epi64(total0, total1)));
+}
+
+// Below that, setting up the Harley-Seal tree costs more than it saves
+constexpr std::size_t harley_seal_threshold = 64;
+
+#endif
+}    // namespace
+
+std::size_t count_blocks(const std::uint64_t* blocks,
+                         std::size_t          count) noexcept
+{
+#if CORGI_BINARY_X86
+    const auto& features = cpu();
+
+    switch(active_simd_level())
+    {
+        case simd_level::avx512:
+            if(features.avx512_popcnt)
+                return avx512_count(blocks, count);
+            [[fallthrough]];
+        case simd_level::avx2:
+            if(count >= harley_seal_threshold)
+                return harley_seal_count(blocks, count);
+            return popcnt_count(blocks, count);
+        case simd_level::scalar:
+            if(features.popcnt)
+                return popcnt_count(blocks, count);
+            break;
+    }
+#endif
+    return generic_count(blocks, count);
+}
+
+}    // namespace corgi::binary::detail
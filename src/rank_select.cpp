@@ -0,0 +1,226 @@
+#include <corgi/binary/rank_select.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace corgi::binary
+{
+namespace
+{
+constexpr std::uint64_t ones_step = 0x0101010101010101;
+constexpr std::uint64_t high_bits = 0x8080808080808080;
+
+constexpr std::size_t words_per_superblock = rank_select::superblock_bits / 64;
+
+/**
+ * @brief   Returns the set bits of the words of a superblock located before
+ *          word @p word, read from the packed counts @p packed
+ */
+std::uint64_t word_rank(std::uint64_t packed, std::size_t word) noexcept
+{
+    return word == 0 ? 0 : (packed >> (9 * (word - 1))) & 0x1FF;
+}
+
+/**
+ * @brief   Returns the position of the set bit of rank @p rank inside
+ *          @p word, which must have more than @p rank set bits
+ */
+std::size_t select_in_word(std::uint64_t word, std::uint64_t rank) noexcept
+{
+    // Byte i of sums holds the set bits of bytes 0 to i
+    constexpr std::uint64_t pairs   = 0x5555555555555555;
+    constexpr std::uint64_t nibbles = 0x3333333333333333;
+    constexpr std::uint64_t bytes   = 0x0F0F0F0F0F0F0F0F;
+
+    auto sums = word - ((word >> 1) & pairs);
+    sums      = (sums & nibbles) + ((sums >> 2) & nibbles);
+    sums      = ((sums + (sums >> 4)) & bytes) * ones_step;
+
+    // Counts the bytes whose sum is lower or equal to the rank : the high bit
+    // of a byte survives the subtraction only in that case
+    const auto byte = static_cast<std::size_t>(
+        std::popcount(((rank * ones_step | high_bits) - sums) & high_bits));
+
+    rank -= ((sums << 8) >> (8 * byte)) & 0xFF;
+
+    auto bits = (word >> (8 * byte)) & 0xFF;
+    for(; rank != 0; rank--)
+        bits &= bits - 1;
+
+    return 8 * byte + static_cast<std::size_t>(std::countr_zero(bits));
+}
+}    // namespace
+
+std::size_t rank_select::rank(std::size_t pos) const
+{
+    if(pos > bit_size_)
+        throw std::out_of_range("Argument pos is out of range");
+
+    if(pos == bit_size_)
+        return count();
+
+    const auto superblock = pos / superblock_bits;
+    const auto word       = pos / 64;
+    const auto offset     = pos % 64;
+
+    // The double shift keeps the bits before offset, and gives 0 when offset
+    // is 0 instead of shifting by 64
+    const auto before = (blocks_[word] << 1) << (63 - offset);
+
+    return counts_[2 * superblock] +
+           word_rank(counts_[2 * superblock + 1],
+                     word % words_per_superblock) +
+           static_cast<std::size_t>(std::popcount(before));
+}
+
+std::size_t rank_select::select(std::size_t k) const noexcept
+{
+    if(k >= count())
+        return npos;
+
+    // The superblock holding the bit is between the 2 samples surrounding k
+    const auto sample = k / select_sample;
+    auto       low    = samples_[sample];
+    auto       high   = sample + 1 < samples_.size() ? samples_[sample + 1] + 1
+                                                     : superblock_count();
+
+    while(high - low > 1)
+    {
+        const auto middle = low + (high - low) / 2;
+        if(counts_[2 * middle] <= k)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    const auto superblock = low;
+    const auto packed     = counts_[2 * superblock + 1];
+    auto       rank       = k - counts_[2 * superblock];
+
+    std::size_t word = 0;
+    while(word + 1 < words_per_superblock &&
+          word_rank(packed, word + 1) <= rank)
+        word++;
+
+    rank -= word_rank(packed, word);
+
+    const auto block = superblock * words_per_superblock + word;
+    return block * 64 + select_in_word(blocks_[block], rank);
+}
+
+void rank_select::build(const std::uint64_t* blocks, std::size_t bit_size)
+{
+    blocks_   = blocks;
+    bit_size_ = bit_size;
+
+    const auto superblocks =
+        (bit_size + superblock_bits - 1) / superblock_bits;
+    counts_.assign(2 * (superblocks + 1), 0);
+
+    counts_[2 * superblocks] = count_superblocks(0, superblocks, 0);
+    sample();
+}
+
+void rank_select::update(const std::uint64_t* blocks,
+                         std::size_t          bit_size,
+                         std::size_t          first,
+                         std::size_t          last)
+{
+    if(first > last)
+        throw std::invalid_argument("Argument first is greater than last");
+
+    if(counts_.empty())
+    {
+        build(blocks, bit_size);
+        return;
+    }
+
+    blocks_ = blocks;
+
+    if(bit_size != bit_size_)
+    {
+        // Superblocks before the first modified bit are still valid
+        const auto from =
+            std::min({first, bit_size, bit_size_}) / superblock_bits;
+
+        bit_size_ = bit_size;
+        const auto superblocks =
+            (bit_size + superblock_bits - 1) / superblock_bits;
+        counts_.resize(2 * (superblocks + 1));
+
+        counts_[2 * superblocks] =
+            count_superblocks(from, superblocks, counts_[2 * from]);
+        counts_[2 * superblocks + 1] = 0;
+        sample();
+        return;
+    }
+
+    if(last > bit_size)
+        throw std::out_of_range("Argument last is out of range");
+
+    if(first == last)
+        return;
+
+    const auto begin = first / superblock_bits;
+    const auto end   = (last - 1) / superblock_bits + 1;
+
+    const auto previous = counts_[2 * end];
+    const auto current =
+        count_superblocks(begin, end, counts_[2 * begin]);
+
+    if(current == previous)
+        return;
+
+    // Unsigned wrap around handles bits being unset
+    const auto delta = current - previous;
+    for(auto superblock = end; superblock <= superblock_count(); superblock++)
+        counts_[2 * superblock] += delta;
+
+    sample();
+}
+
+std::uint64_t rank_select::count_superblocks(std::size_t   first,
+                                             std::size_t   last,
+                                             std::uint64_t total) noexcept
+{
+    const auto block_count = (bit_size_ + 63) / 64;
+
+    for(auto superblock = first; superblock < last; superblock++)
+    {
+        std::uint64_t packed = 0;
+        std::uint64_t ones   = 0;
+
+        // Words after the end of the bitset count as empty
+        for(std::size_t word = 0; word < words_per_superblock; word++)
+        {
+            if(word != 0)
+                packed |= ones << (9 * (word - 1));
+
+            const auto block = superblock * words_per_superblock + word;
+            if(block < block_count)
+                ones += static_cast<std::uint64_t>(
+                    std::popcount(blocks_[block]));
+        }
+
+        counts_[2 * superblock]     = total;
+        counts_[2 * superblock + 1] = packed;
+        total += ones;
+    }
+    return total;
+}
+
+void rank_select::sample()
+{
+    samples_.clear();
+
+    const auto  total      = count();
+    std::size_t superblock = 0;
+    for(std::uint64_t rank = 0; rank < total; rank += select_sample)
+    {
+        while(counts_[2 * (superblock + 1)] <= rank)
+            superblock++;
+        samples_.push_back(superblock);
+    }
+}
+}    // namespace corgi::binary
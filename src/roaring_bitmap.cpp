@@ -0,0 +1,991 @@
+#include <corgi/binary/roaring_bitmap.h>
+
+#include <corgi/binary/detail/block_ops.h>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace corgi::binary
+{
+namespace
+{
+using container = detail::roaring_container;
+using kind      = container::kind;
+using operation = detail::roaring_operation;
+
+constexpr std::size_t chunk_bits   = container::chunk_bits;
+constexpr std::size_t bitmap_words = container::bitmap_words;
+constexpr std::size_t array_max    = container::array_max;
+
+// Bytes taken by the data of each kind of container
+constexpr std::size_t bitmap_bytes = bitmap_words * sizeof(std::uint64_t);
+
+constexpr std::size_t array_bytes(std::size_t cardinality) noexcept
+{
+    return cardinality <= array_max ? cardinality * sizeof(std::uint16_t)
+                                    : std::numeric_limits<std::size_t>::max();
+}
+
+constexpr std::size_t run_bytes(std::size_t runs) noexcept
+{
+    return runs * 2 * sizeof(std::uint16_t);
+}
+
+/**
+ * @brief   Returns the kind of container taking the least memory. Ties go to
+ *          arrays and bitmaps, whose operations are cheaper
+ */
+kind smallest_kind(std::size_t cardinality, std::size_t runs) noexcept
+{
+    const auto best = cardinality <= array_max ? kind::array : kind::bitmap;
+    const auto best_bytes =
+        best == kind::array ? array_bytes(cardinality) : bitmap_bytes;
+    return run_bytes(runs) < best_bytes ? kind::run : best;
+}
+
+bool apply(operation op, bool a, bool b) noexcept
+{
+    switch(op)
+    {
+        case operation::and_op:
+            return a && b;
+        case operation::or_op:
+            return a || b;
+        case operation::xor_op:
+            return a != b;
+        case operation::andnot_op:
+            return a && !b;
+    }
+    return false;
+}
+
+/**
+ * @brief   Returns the number of runs of @p c that start at or before
+ *          @p value
+ */
+std::size_t runs_before(const container& c, std::uint16_t value) noexcept
+{
+    std::size_t low  = 0;
+    std::size_t high = c.values.size() / 2;
+    while(low < high)
+    {
+        const auto middle = low + (high - low) / 2;
+        if(c.values[2 * middle] <= value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+bool contains(const container& c, std::uint16_t value) noexcept
+{
+    switch(c.type)
+    {
+        case kind::array:
+            return std::binary_search(c.values.begin(), c.values.end(),
+                                      value);
+        case kind::bitmap:
+            return (c.words[value / 64] >> (value % 64)) & 1;
+        case kind::run:
+        {
+            const auto run = runs_before(c, value);
+            return run != 0 && c.values[2 * run - 1] >= value;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief   Sets the bits in [@p first, @p last] of @p words
+ */
+void set_bits(std::uint64_t* words, std::size_t first, std::size_t last)
+{
+    const auto first_word = first / 64;
+    const auto last_word  = last / 64;
+    const auto first_mask = ~std::uint64_t {0} << (first % 64);
+    const auto last_mask  = ~std::uint64_t {0} >> (63 - last % 64);
+
+    if(first_word == last_word)
+    {
+        words[first_word] |= first_mask & last_mask;
+        return;
+    }
+
+    words[first_word] |= first_mask;
+    std::fill(words + first_word + 1, words + last_word, ~std::uint64_t {0});
+    words[last_word] |= last_mask;
+}
+
+/**
+ * @brief   Returns the number of runs of set bits inside @p count words
+ */
+std::size_t count_runs(const std::uint64_t* words, std::size_t count) noexcept
+{
+    std::size_t   runs     = 0;
+    std::uint64_t previous = 0;
+    for(std::size_t i = 0; i < count; i++)
+    {
+        // A run starts on every set bit whose previous bit isn't set
+        const auto starts = words[i] & ~((words[i] << 1) | (previous >> 63));
+        runs += static_cast<std::size_t>(std::popcount(starts));
+        previous = words[i];
+    }
+    return runs;
+}
+
+std::size_t count_runs(const container& c) noexcept
+{
+    switch(c.type)
+    {
+        case kind::array:
+        {
+            std::size_t runs = 1;
+            for(std::size_t i = 1; i < c.values.size(); i++)
+                runs += c.values[i] != c.values[i - 1] + 1;
+            return runs;
+        }
+        case kind::bitmap:
+            return count_runs(c.words.data(), bitmap_words);
+        case kind::run:
+            return c.values.size() / 2;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Returns the position of the first bit equal to @p value at or
+ *          after @p pos, or chunk_bits if there's none
+ */
+std::size_t
+find_bit(const std::uint64_t* words, std::size_t pos, bool value) noexcept
+{
+    const auto flip = value ? std::uint64_t {0} : ~std::uint64_t {0};
+
+    auto index = pos / 64;
+    auto word  = (words[index] ^ flip) & (~std::uint64_t {0} << (pos % 64));
+    while(word == 0)
+    {
+        if(++index == bitmap_words)
+            return chunk_bits;
+        word = words[index] ^ flip;
+    }
+    return index * 64 + static_cast<std::size_t>(std::countr_zero(word));
+}
+
+/**
+ * @brief   Writes the bits of @p c inside @p words, which must be 0
+ */
+void write_words(const container& c, std::uint64_t* words) noexcept
+{
+    switch(c.type)
+    {
+        case kind::array:
+            for(const auto value : c.values)
+                words[value / 64] |= std::uint64_t {1} << (value % 64);
+            break;
+        case kind::bitmap:
+            std::copy(c.words.begin(), c.words.end(), words);
+            break;
+        case kind::run:
+            for(std::size_t i = 0; i < c.values.size(); i += 2)
+                set_bits(words, c.values[i], c.values[i + 1]);
+            break;
+    }
+}
+
+/**
+ * @brief   Fills @p c with the set bits of @p words, stored as @p target.
+ *          The cardinality of @p c must already match
+ *
+ * @p words can be the words of @p c when @p target isn't a bitmap, they are
+ * released after being read.
+ */
+void assign_words(container&           c,
+                  const std::uint64_t* words,
+                  kind                 target,
+                  std::size_t          runs = 0)
+{
+    c.type = target;
+    c.values.clear();
+
+    switch(target)
+    {
+        case kind::array:
+            c.values.reserve(c.cardinality);
+            for(std::size_t i = 0; i < bitmap_words; i++)
+            {
+                for(auto word = words[i]; word != 0; word &= word - 1)
+                    c.values.push_back(static_cast<std::uint16_t>(
+                        i * 64 +
+                        static_cast<std::size_t>(std::countr_zero(word))));
+            }
+            c.words = {};
+            break;
+
+        case kind::bitmap:
+            c.words.assign(words, words + bitmap_words);
+            break;
+
+        case kind::run:
+            c.values.reserve(2 * runs);
+            for(auto pos = find_bit(words, 0, true); pos != chunk_bits;)
+            {
+                const auto end =
+                    pos + 1 == chunk_bits ? chunk_bits
+                                          : find_bit(words, pos + 1, false);
+                c.values.push_back(static_cast<std::uint16_t>(pos));
+                c.values.push_back(static_cast<std::uint16_t>(end - 1));
+                pos = end == chunk_bits ? chunk_bits
+                                        : find_bit(words, end, true);
+            }
+            c.words = {};
+            break;
+    }
+}
+
+void convert(container& c, kind target)
+{
+    if(c.type == target)
+        return;
+
+    std::vector<std::uint64_t> words(bitmap_words);
+    write_words(c, words.data());
+
+    if(target == kind::bitmap)
+    {
+        c.type   = kind::bitmap;
+        c.words  = std::move(words);
+        c.values = {};
+        return;
+    }
+    assign_words(c, words.data(), target,
+                 count_runs(words.data(), bitmap_words));
+}
+
+/**
+ * @brief   Moves @p c to an array or a bitmap depending on its cardinality.
+ *          A run container is kept if it's still the smallest, with the tie
+ *          rule of smallest_kind()
+ */
+void normalize(container& c)
+{
+    if(c.type == kind::run &&
+       smallest_kind(c.cardinality, c.values.size() / 2) == kind::run)
+        return;
+
+    convert(c, c.cardinality <= array_max ? kind::array : kind::bitmap);
+}
+
+/**
+ * @brief   Set operation between 2 lists of runs, walking the boundaries of
+ *          both lists in order
+ */
+container combine_runs(const container& a, const container& b, operation op)
+{
+    // Boundary k of a list is the first bit of a run when k is even, the bit
+    // after its end otherwise. After passing k boundaries, a position is in
+    // the list if k is odd
+    constexpr auto none     = std::numeric_limits<std::uint32_t>::max();
+    const auto     boundary = [](const container& c, std::size_t k)
+    { return k < c.values.size() ? c.values[k] + std::uint32_t(k % 2) : none; };
+
+    container result;
+    result.type = kind::run;
+
+    std::size_t   ka     = 0;
+    std::size_t   kb     = 0;
+    bool          inside = false;
+    std::uint32_t first  = 0;
+
+    while(ka < a.values.size() || kb < b.values.size())
+    {
+        const auto next = std::min(boundary(a, ka), boundary(b, kb));
+        while(boundary(a, ka) == next)
+            ka++;
+        while(boundary(b, kb) == next)
+            kb++;
+
+        const auto in = apply(op, ka % 2 == 1, kb % 2 == 1);
+        if(in == inside)
+            continue;
+
+        if(in)
+            first = next;
+        else
+        {
+            result.values.push_back(static_cast<std::uint16_t>(first));
+            result.values.push_back(static_cast<std::uint16_t>(next - 1));
+            result.cardinality += next - first;
+        }
+        inside = in;
+    }
+
+    normalize(result);
+    return result;
+}
+
+container combine_arrays(const container& a, const container& b, operation op)
+{
+    container result;
+
+    // Unions can go past array_max, normalize moves them to a bitmap
+    auto out = std::back_inserter(result.values);
+    switch(op)
+    {
+        case operation::and_op:
+            std::set_intersection(a.values.begin(), a.values.end(),
+                                  b.values.begin(), b.values.end(), out);
+            break;
+        case operation::or_op:
+            std::set_union(a.values.begin(), a.values.end(), b.values.begin(),
+                           b.values.end(), out);
+            break;
+        case operation::xor_op:
+            std::set_symmetric_difference(a.values.begin(), a.values.end(),
+                                          b.values.begin(), b.values.end(),
+                                          out);
+            break;
+        case operation::andnot_op:
+            std::set_difference(a.values.begin(), a.values.end(),
+                                b.values.begin(), b.values.end(), out);
+            break;
+    }
+
+    result.cardinality = static_cast<std::uint32_t>(result.values.size());
+    normalize(result);
+    return result;
+}
+
+/**
+ * @brief   Keeps the values of the array @p a that are (or aren't, when
+ *          @p keep is false) inside @p b
+ */
+container filter_array(const container& a, const container& b, bool keep)
+{
+    container result;
+    result.values.reserve(a.values.size());
+    for(const auto value : a.values)
+    {
+        if(contains(b, value) == keep)
+            result.values.push_back(value);
+    }
+    result.cardinality = static_cast<std::uint32_t>(result.values.size());
+    return result;
+}
+
+/**
+ * @brief   Applies the values of the array @p values to a copy of the
+ *          bitmap @p bitmap
+ */
+container
+update_bitmap(const container& bitmap, const container& values, operation op)
+{
+    container result = bitmap;
+    auto&     card   = result.cardinality;
+
+    for(const auto value : values.values)
+    {
+        auto&      word = result.words[value / 64];
+        const auto mask = std::uint64_t {1} << (value % 64);
+        const auto set  = (word & mask) != 0;
+
+        if(op == operation::xor_op || set == (op == operation::andnot_op))
+        {
+            word ^= mask;
+            card = set ? card - 1 : card + 1;
+        }
+    }
+
+    normalize(result);
+    return result;
+}
+
+/**
+ * @brief   Returns the runs of consecutive values of the array @p c
+ */
+container array_runs(const container& c)
+{
+    container result;
+    result.type        = kind::run;
+    result.cardinality = c.cardinality;
+
+    for(std::size_t i = 0; i < c.values.size(); i++)
+    {
+        if(i == 0 || c.values[i] != c.values[i - 1] + 1)
+        {
+            result.values.push_back(c.values[i]);
+            result.values.push_back(c.values[i]);
+        }
+        else
+            result.values.back() = c.values[i];
+    }
+    return result;
+}
+
+/**
+ * @brief   Returns the set operation of 2 containers, whose cardinality is 0
+ *          when the result is empty
+ */
+container combine(const container& a, const container& b, operation op)
+{
+    if(a.type == kind::run && b.type == kind::run)
+        return combine_runs(a, b, op);
+
+    if(a.type == kind::array && b.type == kind::array)
+        return combine_arrays(a, b, op);
+
+    // Small arrays only need to probe the other container
+    if(a.type == kind::array &&
+       (op == operation::and_op || op == operation::andnot_op))
+        return filter_array(a, b, op == operation::and_op);
+
+    if(b.type == kind::array && op == operation::and_op)
+        return filter_array(b, a, true);
+
+    if(a.type == kind::bitmap && b.type == kind::array)
+        return update_bitmap(a, b, op);
+
+    if(b.type == kind::bitmap && a.type == kind::array &&
+       op != operation::andnot_op)
+        return update_bitmap(b, a, op);
+
+    // Arrays are cheap to turn into runs, and the result of a run operation
+    // often stays a run
+    if(a.type == kind::array && b.type == kind::run)
+        return combine_runs(array_runs(a), b, op);
+
+    if(a.type == kind::run && b.type == kind::array)
+        return combine_runs(a, array_runs(b), op);
+
+    // Everything else goes through the SIMD kernels on full bitmaps
+    std::vector<std::uint64_t> scratch_a;
+    std::vector<std::uint64_t> scratch_b;
+    const auto                 words_of =
+        [](const container& c, std::vector<std::uint64_t>& scratch)
+    {
+        if(c.type == kind::bitmap)
+            return c.words.data();
+        scratch.assign(bitmap_words, 0);
+        write_words(c, scratch.data());
+        return static_cast<const std::uint64_t*>(scratch.data());
+    };
+
+    const auto* wa = words_of(a, scratch_a);
+    const auto* wb = words_of(b, scratch_b);
+
+    container result;
+    result.type = kind::bitmap;
+    result.words.resize(bitmap_words);
+
+    auto* dst = result.words.data();
+    switch(op)
+    {
+        case operation::and_op:
+            detail::and_blocks(dst, wa, wb, bitmap_words);
+            break;
+        case operation::or_op:
+            detail::or_blocks(dst, wa, wb, bitmap_words);
+            break;
+        case operation::xor_op:
+            detail::xor_blocks(dst, wa, wb, bitmap_words);
+            break;
+        case operation::andnot_op:
+            detail::andnot_blocks(dst, wa, wb, bitmap_words);
+            break;
+    }
+
+    result.cardinality =
+        static_cast<std::uint32_t>(detail::count_blocks(dst, bitmap_words));
+
+    // Only worth counting the runs of the result when a run was involved
+    if(a.type == kind::run || b.type == kind::run)
+    {
+        const auto runs = count_runs(dst, bitmap_words);
+        const auto best = smallest_kind(result.cardinality, runs);
+        if(best != kind::bitmap)
+            assign_words(result, dst, best, runs);
+        return result;
+    }
+
+    normalize(result);
+    return result;
+}
+
+bool equals(const container& a, const container& b)
+{
+    if(a.cardinality != b.cardinality)
+        return false;
+
+    if(a.type == b.type)
+        return a.values == b.values && a.words == b.words;
+
+    // Same bits stored differently
+    return combine(a, b, operation::xor_op).cardinality == 0;
+}
+}    // namespace
+
+roaring_bitmap::roaring_bitmap(std::initializer_list<std::size_t> positions)
+{
+    for(const auto pos : positions)
+        add(pos);
+}
+
+void roaring_bitmap::add(std::size_t pos)
+{
+    if(pos == npos)
+        throw std::out_of_range("Argument pos is out of range");
+
+    const auto key   = pos / chunk_bits;
+    const auto value = static_cast<std::uint16_t>(pos % chunk_bits);
+    const auto index = lower_bound(key);
+
+    if(index == keys_.size() || keys_[index] != key)
+    {
+        container c;
+        c.cardinality = 1;
+        c.values.push_back(value);
+        keys_.insert(keys_.begin() + static_cast<std::ptrdiff_t>(index), key);
+        containers_.insert(
+            containers_.begin() + static_cast<std::ptrdiff_t>(index),
+            std::move(c));
+        return;
+    }
+
+    auto& c = containers_[index];
+    switch(c.type)
+    {
+        case kind::array:
+        {
+            const auto it =
+                std::lower_bound(c.values.begin(), c.values.end(), value);
+            if(it != c.values.end() && *it == value)
+                return;
+            c.values.insert(it, value);
+            break;
+        }
+
+        case kind::bitmap:
+        {
+            auto&      word = c.words[value / 64];
+            const auto mask = std::uint64_t {1} << (value % 64);
+            if(word & mask)
+                return;
+            word |= mask;
+            break;
+        }
+
+        case kind::run:
+        {
+            const auto run = runs_before(c, value);
+            if(run != 0 && c.values[2 * run - 1] >= value)
+                return;
+
+            // The value can extend the previous run, the next one, or join
+            // both of them
+            const bool join_previous =
+                run != 0 && c.values[2 * run - 1] + 1 == value;
+            const bool join_next =
+                2 * run < c.values.size() && c.values[2 * run] == value + 1;
+
+            const auto at = c.values.begin() + static_cast<std::ptrdiff_t>(
+                                                   2 * run);
+            if(join_previous && join_next)
+            {
+                c.values[2 * run - 1] = c.values[2 * run + 1];
+                c.values.erase(at, at + 2);
+            }
+            else if(join_previous)
+                c.values[2 * run - 1] = value;
+            else if(join_next)
+                c.values[2 * run] = value;
+            else
+                c.values.insert(at, {value, value});
+            break;
+        }
+    }
+
+    c.cardinality++;
+    normalize(c);
+}
+
+void roaring_bitmap::add_range(std::size_t first, std::size_t last)
+{
+    if(first > last)
+        throw std::invalid_argument("Argument first is greater than last");
+
+    if(first == last)
+        return;
+
+    const auto first_key = first / chunk_bits;
+    const auto last_key  = (last - 1) / chunk_bits;
+
+    for(auto key = first_key; key <= last_key; key++)
+    {
+        const auto low  = key == first_key ? first % chunk_bits : 0;
+        const auto high = key == last_key ? (last - 1) % chunk_bits
+                                          : chunk_bits - 1;
+
+        container range;
+        range.type        = kind::run;
+        range.cardinality = static_cast<std::uint32_t>(high - low + 1);
+        range.values      = {static_cast<std::uint16_t>(low),
+                             static_cast<std::uint16_t>(high)};
+
+        const auto index = lower_bound(key);
+        if(index == keys_.size() || keys_[index] != key)
+        {
+            normalize(range);
+            keys_.insert(keys_.begin() + static_cast<std::ptrdiff_t>(index),
+                         key);
+            containers_.insert(
+                containers_.begin() + static_cast<std::ptrdiff_t>(index),
+                std::move(range));
+        }
+        else
+        {
+            containers_[index] =
+                binary::combine(containers_[index], range, operation::or_op);
+        }
+    }
+}
+
+void roaring_bitmap::remove(std::size_t pos)
+{
+    const auto key   = pos / chunk_bits;
+    const auto value = static_cast<std::uint16_t>(pos % chunk_bits);
+    const auto index = lower_bound(key);
+
+    if(index == keys_.size() || keys_[index] != key)
+        return;
+
+    auto& c = containers_[index];
+    switch(c.type)
+    {
+        case kind::array:
+        {
+            const auto it =
+                std::lower_bound(c.values.begin(), c.values.end(), value);
+            if(it == c.values.end() || *it != value)
+                return;
+            c.values.erase(it);
+            break;
+        }
+
+        case kind::bitmap:
+        {
+            auto&      word = c.words[value / 64];
+            const auto mask = std::uint64_t {1} << (value % 64);
+            if((word & mask) == 0)
+                return;
+            word &= ~mask;
+            break;
+        }
+
+        case kind::run:
+        {
+            auto run = runs_before(c, value);
+            if(run == 0 || c.values[2 * run - 1] < value)
+                return;
+            run--;
+
+            const auto run_first = c.values[2 * run];
+            const auto run_last  = c.values[2 * run + 1];
+            const auto at        = c.values.begin() +
+                            static_cast<std::ptrdiff_t>(2 * run);
+
+            if(run_first == run_last)
+                c.values.erase(at, at + 2);
+            else if(value == run_first)
+                c.values[2 * run]++;
+            else if(value == run_last)
+                c.values[2 * run + 1]--;
+            else
+            {
+                // Splits the run in 2
+                c.values[2 * run + 1] = static_cast<std::uint16_t>(value - 1);
+                c.values.insert(at + 2,
+                                {static_cast<std::uint16_t>(value + 1),
+                                 run_last});
+            }
+            break;
+        }
+    }
+
+    if(--c.cardinality == 0)
+    {
+        keys_.erase(keys_.begin() + static_cast<std::ptrdiff_t>(index));
+        containers_.erase(containers_.begin() +
+                          static_cast<std::ptrdiff_t>(index));
+        return;
+    }
+    normalize(c);
+}
+
+bool roaring_bitmap::contains(std::size_t pos) const noexcept
+{
+    const auto key   = pos / chunk_bits;
+    const auto index = lower_bound(key);
+
+    return index != keys_.size() && keys_[index] == key &&
+           binary::contains(containers_[index],
+                            static_cast<std::uint16_t>(pos % chunk_bits));
+}
+
+void roaring_bitmap::clear() noexcept
+{
+    keys_.clear();
+    containers_.clear();
+}
+
+std::size_t roaring_bitmap::count() const noexcept
+{
+    std::size_t total = 0;
+    for(const auto& c : containers_)
+        total += c.cardinality;
+    return total;
+}
+
+std::size_t roaring_bitmap::find_first() const noexcept
+{
+    if(empty())
+        return npos;
+
+    const auto& c    = containers_.front();
+    const auto  base = keys_.front() * chunk_bits;
+
+    if(c.type != kind::bitmap)
+        return base + c.values.front();
+
+    const auto word =
+        detail::find_nonzero_block(c.words.data(), 0, bitmap_words);
+    return base + word * 64 +
+           static_cast<std::size_t>(std::countr_zero(c.words[word]));
+}
+
+std::size_t roaring_bitmap::find_last() const noexcept
+{
+    if(empty())
+        return npos;
+
+    const auto& c    = containers_.back();
+    const auto  base = keys_.back() * chunk_bits;
+
+    // The last value of a run container is the end of its last run
+    if(c.type != kind::bitmap)
+        return base + c.values.back();
+
+    const auto word =
+        detail::rfind_nonzero_block(c.words.data(), 0, bitmap_words);
+    return base + word * 64 + 63 -
+           static_cast<std::size_t>(std::countl_zero(c.words[word]));
+}
+
+bool roaring_bitmap::run_optimize()
+{
+    bool converted = false;
+    for(auto& c : containers_)
+    {
+        if(c.type == kind::run)
+            continue;
+
+        if(smallest_kind(c.cardinality, count_runs(c)) == kind::run)
+        {
+            convert(c, kind::run);
+            converted = true;
+        }
+    }
+    return converted;
+}
+
+void roaring_bitmap::shrink_to_fit()
+{
+    keys_.shrink_to_fit();
+    containers_.shrink_to_fit();
+    for(auto& c : containers_)
+    {
+        c.values.shrink_to_fit();
+        c.words.shrink_to_fit();
+    }
+}
+
+std::size_t roaring_bitmap::memory_usage() const noexcept
+{
+    auto bytes = sizeof(*this) + keys_.capacity() * sizeof(std::size_t) +
+                 containers_.capacity() * sizeof(container);
+
+    for(const auto& c : containers_)
+        bytes += c.values.capacity() * sizeof(std::uint16_t) +
+                 c.words.capacity() * sizeof(std::uint64_t);
+    return bytes;
+}
+
+bool roaring_bitmap::operator==(const roaring_bitmap& other) const
+{
+    if(keys_ != other.keys_)
+        return false;
+
+    for(std::size_t i = 0; i < containers_.size(); i++)
+    {
+        if(!equals(containers_[i], other.containers_[i]))
+            return false;
+    }
+    return true;
+}
+
+roaring_bitmap& roaring_bitmap::operator&=(const roaring_bitmap& other)
+{
+    return *this = combine(*this, other, operation::and_op);
+}
+
+roaring_bitmap& roaring_bitmap::operator|=(const roaring_bitmap& other)
+{
+    return *this = combine(*this, other, operation::or_op);
+}
+
+roaring_bitmap& roaring_bitmap::operator^=(const roaring_bitmap& other)
+{
+    return *this = combine(*this, other, operation::xor_op);
+}
+
+roaring_bitmap& roaring_bitmap::operator-=(const roaring_bitmap& other)
+{
+    return *this = combine(*this, other, operation::andnot_op);
+}
+
+roaring_bitmap operator&(const roaring_bitmap& lhs, const roaring_bitmap& rhs)
+{
+    return roaring_bitmap::combine(lhs, rhs, operation::and_op);
+}
+
+roaring_bitmap operator|(const roaring_bitmap& lhs, const roaring_bitmap& rhs)
+{
+    return roaring_bitmap::combine(lhs, rhs, operation::or_op);
+}
+
+roaring_bitmap operator^(const roaring_bitmap& lhs, const roaring_bitmap& rhs)
+{
+    return roaring_bitmap::combine(lhs, rhs, operation::xor_op);
+}
+
+roaring_bitmap operator-(const roaring_bitmap& lhs, const roaring_bitmap& rhs)
+{
+    return roaring_bitmap::combine(lhs, rhs, operation::andnot_op);
+}
+
+roaring_bitmap roaring_bitmap::combine(const roaring_bitmap& lhs,
+                                       const roaring_bitmap& rhs,
+                                       operation             op)
+{
+    roaring_bitmap result;
+
+    // Chunks only present on one side are copied, or dropped when the
+    // operation would make them empty
+    const bool keep_lhs = op != operation::and_op;
+    const bool keep_rhs = op == operation::or_op || op == operation::xor_op;
+
+    const auto push = [&result](std::size_t key, container c)
+    {
+        result.keys_.push_back(key);
+        result.containers_.push_back(std::move(c));
+    };
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while(i < lhs.keys_.size() && j < rhs.keys_.size())
+    {
+        if(lhs.keys_[i] < rhs.keys_[j])
+        {
+            if(keep_lhs)
+                push(lhs.keys_[i], lhs.containers_[i]);
+            i++;
+        }
+        else if(rhs.keys_[j] < lhs.keys_[i])
+        {
+            if(keep_rhs)
+                push(rhs.keys_[j], rhs.containers_[j]);
+            j++;
+        }
+        else
+        {
+            auto c = binary::combine(lhs.containers_[i], rhs.containers_[j],
+                                     op);
+            if(c.cardinality != 0)
+                push(lhs.keys_[i], std::move(c));
+            i++;
+            j++;
+        }
+    }
+
+    for(; keep_lhs && i < lhs.keys_.size(); i++)
+        push(lhs.keys_[i], lhs.containers_[i]);
+
+    for(; keep_rhs && j < rhs.keys_.size(); j++)
+        push(rhs.keys_[j], rhs.containers_[j]);
+
+    return result;
+}
+
+void roaring_bitmap::assign(const std::uint64_t* blocks,
+                            std::size_t          block_count)
+{
+    clear();
+
+    std::vector<std::uint64_t> words(bitmap_words);
+    for(std::size_t first = 0; first < block_count; first += bitmap_words)
+    {
+        const auto count = std::min(bitmap_words, block_count - first);
+        if(detail::find_nonzero_block(blocks, first, first + count) ==
+           first + count)
+            continue;
+
+        std::fill(std::copy(blocks + first, blocks + first + count,
+                            words.begin()),
+                  words.end(), 0);
+
+        container c;
+        c.cardinality = static_cast<std::uint32_t>(
+            detail::count_blocks(words.data(), bitmap_words));
+
+        const auto runs = count_runs(words.data(), bitmap_words);
+        assign_words(c, words.data(), smallest_kind(c.cardinality, runs),
+                     runs);
+
+        keys_.push_back(first / bitmap_words);
+        containers_.push_back(std::move(c));
+    }
+}
+
+void roaring_bitmap::copy_to(std::uint64_t* blocks, std::size_t bit_size) const
+{
+    if(!empty() && find_last() >= bit_size)
+        throw std::out_of_range("The bitmap holds positions past size");
+
+    const auto block_count = detail::block_count<std::uint64_t>(bit_size);
+
+    for(std::size_t i = 0; i < containers_.size(); i++)
+    {
+        const auto& c     = containers_[i];
+        const auto  first = keys_[i] * bitmap_words;
+
+        // The last chunk can be cut by the end of the bitset, but none of
+        // its set bits are past it
+        if(c.type == kind::bitmap)
+            std::copy_n(c.words.begin(),
+                        std::min(bitmap_words, block_count - first),
+                        blocks + first);
+        else
+            write_words(c, blocks + first);
+    }
+}
+
+std::size_t roaring_bitmap::lower_bound(std::size_t key) const noexcept
+{
+    return static_cast<std::size_t>(
+        std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin());
+}
+}    // namespace corgi::binary
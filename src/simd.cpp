@@ -0,0 +1,98 @@
+#include "simd_target.h"
+
+#include <corgi/binary/simd.h>
+
+#include <atomic>
+#include <stdexcept>
+
+namespace corgi::binary
+{
+namespace detail
+{
+#if CORGI_BINARY_X86
+static cpu_features detect_cpu_features() noexcept
+{
+    cpu_features features;
+#    if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    const bool os_xsave = (info[2] & (1 << 27)) != 0;
+    features.popcnt     = (info[2] & (1 << 23)) != 0;
+
+    // The OS must save the ymm and zmm registers for us to use them
+    const auto xcr0      = os_xsave ? _xgetbv(0) : 0;
+    const bool os_avx    = (xcr0 & 0x6) == 0x6;
+    const bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+    if(max_leaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        features.bmi2   = (info[1] & (1 << 8)) != 0;
+        features.avx2   = features.bmi2 && os_avx &&
+                          (info[1] & (1 << 5)) != 0;
+        features.avx512 = os_avx512 && (info[1] & (1 << 16)) != 0 &&
+                          (info[1] & (1 << 30)) != 0;
+        features.avx512_popcnt =
+            features.avx512 && (info[2] & (1 << 14)) != 0;
+    }
+#    else
+    __builtin_cpu_init();
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.bmi2   = __builtin_cpu_supports("bmi2");
+    features.avx2   = __builtin_cpu_supports("avx2") && features.bmi2;
+    features.avx512 = __builtin_cpu_supports("avx512f") &&
+                      __builtin_cpu_supports("avx512bw") && features.avx2;
+    features.avx512_popcnt =
+        features.avx512 && __builtin_cpu_supports("avx512vpopcntdq");
+#    endif
+    return features;
+}
+#else
+static cpu_features detect_cpu_features() noexcept
+{
+    return {};
+}
+#endif
+
+const cpu_features& cpu() noexcept
+{
+    static const cpu_features features = detect_cpu_features();
+    return features;
+}
+
+}    // namespace detail
+
+static std::atomic<simd_level>& current_level() noexcept
+{
+    static std::atomic<simd_level> level {detected_simd_level()};
+    return level;
+}
+
+simd_level detected_simd_level() noexcept
+{
+    const auto& features = detail::cpu();
+    if(features.avx512)
+        return simd_level::avx512;
+    if(features.avx2)
+        return simd_level::avx2;
+    return simd_level::scalar;
+}
+
+simd_level active_simd_level() noexcept
+{
+    return current_level().load(std::memory_order_relaxed);
+}
+
+void set_simd_level(simd_level level)
+{
+    if(level > detected_simd_level())
+        throw std::invalid_argument(
+            "Argument level isn't supported by the current CPU");
+
+    current_level().store(level, std::memory_order_relaxed);
+}
+
+}    // namespace corgi::binary
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <corgi/binary/simd.h>
+
+// Private helpers shared by the translation units that hold SIMD kernels.
+//
+// Kernels are compiled with per function target attributes instead of global
+// -mavx2 like flags, so the library still runs on CPUs that lack the
+// instruction sets. The right kernel is chosen at runtime.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define CORGI_BINARY_X86 1
+// GCC 12 warns about the _mm*_undefined_* helpers used inside its own
+// AVX-512 intrinsics
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wuninitialized"
+#        pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#        include <immintrin.h>
+#        pragma GCC diagnostic pop
+#    else
+#        include <immintrin.h>
+#    endif
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#        define CORGI_BINARY_TARGET_AVX2
+#        define CORGI_BINARY_TARGET_AVX512
+#        define CORGI_BINARY_TARGET_AVX512_POPCNT
+#        define CORGI_BINARY_TARGET_BMI
+#    else
+#        define CORGI_BINARY_TARGET_AVX2 \
+            __attribute__((target("avx2,bmi,bmi2,popcnt,lzcnt")))
+#        define CORGI_BINARY_TARGET_AVX512 \
+            __attribute__((target("avx512f,avx512bw,avx2,bmi,bmi2,popcnt")))
+#        define CORGI_BINARY_TARGET_AVX512_POPCNT                               \
+            __attribute__((target(                                            \
+                "avx512f,avx512bw,avx512vpopcntdq,avx2,bmi,bmi2,popcnt")))
+#        define CORGI_BINARY_TARGET_BMI \
+            __attribute__((target("bmi,bmi2,popcnt,lzcnt")))
+#    endif
+#else
+#    define CORGI_BINARY_X86 0
+#endif
+
+namespace corgi::binary::detail
+{
+/**
+ * @brief   Instruction set extensions detected on the current CPU
+ */
+struct cpu_features
+{
+    bool popcnt {false};
+    bool bmi2 {false};
+    bool avx2 {false};
+    bool avx512 {false};
+    bool avx512_popcnt {false};
+};
+
+/**
+ * @brief   Returns the features of the current CPU, detected once
+ */
+const cpu_features& cpu() noexcept;
+
+}    // namespace corgi::binary::detail
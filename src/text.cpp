@@ -0,0 +1,211 @@
+#include <corgi/binary/detail/text.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+namespace corgi::binary::detail
+{
+namespace
+{
+// One byte per lane, 8 lanes in a word
+constexpr std::uint64_t lane_ones = 0x0101010101010101ULL;
+
+// Multiplying 8 lanes holding 0 or 1 by this gathers lane i in bit 56 + i
+constexpr std::uint64_t lane_gather = 0x0102040810204080ULL;
+
+/**
+ * @brief   For each byte value, a word whose byte i is bit i of the value
+ */
+constexpr std::array<std::uint64_t, 256> spread_table = []
+{
+    std::array<std::uint64_t, 256> table {};
+    for(std::size_t value = 0; value < 256; value++)
+        for(std::size_t bit = 0; bit < 8; bit++)
+            table[value] |= static_cast<std::uint64_t>((value >> bit) & 1U)
+                            << (bit * 8);
+    return table;
+}();
+
+constexpr char hex_digits[] = "0123456789abcdef";
+
+/**
+ * @brief   For each byte value, its two hexadecimal digits
+ */
+constexpr std::array<std::array<char, 2>, 256> hex_table = []
+{
+    std::array<std::array<char, 2>, 256> table {};
+    for(std::size_t value = 0; value < 256; value++)
+        table[value] = {hex_digits[value >> 4], hex_digits[value & 0xF]};
+    return table;
+}();
+
+/**
+ * @brief   For each character, the value of the hexadecimal digit or 0xFF
+ */
+constexpr std::array<std::uint8_t, 256> hex_values = []
+{
+    std::array<std::uint8_t, 256> table {};
+    table.fill(0xFF);
+    for(std::uint8_t value = 0; value < 16; value++)
+    {
+        table[static_cast<unsigned char>("0123456789abcdef"[value])] = value;
+        table[static_cast<unsigned char>("0123456789ABCDEF"[value])] = value;
+    }
+    return table;
+}();
+
+std::uint64_t load_word(const char* text) noexcept
+{
+    std::uint64_t word;
+    std::memcpy(&word, text, sizeof(word));
+    return word;
+}
+
+bool chars_to_bits_scalar(const char*    text,
+                          std::size_t    count,
+                          unsigned char* bytes,
+                          char           zero,
+                          char           one) noexcept
+{
+    for(std::size_t i = 0; i < count; i += 8)
+    {
+        unsigned value = 0;
+        for(std::size_t bit = 0; bit < 8 && i + bit < count; bit++)
+        {
+            const char c = text[i + bit];
+            if(c == one)
+                value |= 1U << bit;
+            else if(c != zero)
+                return false;
+        }
+        bytes[i / 8] = static_cast<unsigned char>(value);
+    }
+    return true;
+}
+}    // namespace
+
+void bits_to_chars(const unsigned char* bytes,
+                   std::size_t          bit_count,
+                   char*                out,
+                   char                 zero,
+                   char                 one) noexcept
+{
+    // Lanes holding 0 stay zero, lanes holding 1 become zero ^ zero ^ one
+    const std::uint64_t base = lane_ones * static_cast<unsigned char>(zero);
+    const std::uint64_t flip = static_cast<unsigned char>(zero ^ one);
+
+    const std::size_t full_bytes = bit_count / 8;
+    for(std::size_t i = 0; i < full_bytes; i++)
+    {
+        const std::uint64_t chars = base ^ (spread_table[bytes[i]] * flip);
+        std::memcpy(out + i * 8, &chars, sizeof(chars));
+    }
+
+    for(std::size_t bit = full_bytes * 8; bit < bit_count; bit++)
+        out[bit] = ((bytes[bit / 8] >> (bit % 8)) & 1U) != 0 ? one : zero;
+}
+
+bool chars_to_bits(const char*    text,
+                   std::size_t    count,
+                   unsigned char* bytes,
+                   char           zero,
+                   char           one) noexcept
+{
+    const auto difference = static_cast<unsigned char>(zero ^ one);
+
+    // The word at a time path needs the two characters to differ by a single
+    // bit, which is the case of '0' and '1'
+    if(!std::has_single_bit(difference))
+        return chars_to_bits_scalar(text, count, bytes, zero, one);
+
+    const std::uint64_t base  = lane_ones * static_cast<unsigned char>(zero);
+    const std::uint64_t valid = lane_ones * difference;
+    const int           shift = std::countr_zero(difference);
+
+    const std::size_t full_bytes = count / 8;
+    std::uint64_t     invalid    = 0;
+    for(std::size_t i = 0; i < full_bytes; i++)
+    {
+        const std::uint64_t lanes = load_word(text + i * 8) ^ base;
+        invalid |= lanes & ~valid;
+        bytes[i] = static_cast<unsigned char>(
+            (((lanes >> shift) & lane_ones) * lane_gather) >> 56);
+    }
+    if(invalid != 0)
+        return false;
+
+    return chars_to_bits_scalar(text + full_bytes * 8,
+                                count - full_bytes * 8,
+                                bytes + full_bytes,
+                                zero,
+                                one);
+}
+
+void bits_to_hex(const unsigned char* bytes,
+                 std::size_t          bit_count,
+                 char*                out) noexcept
+{
+    const std::size_t digits = (bit_count + 3) / 4;
+    std::size_t       byte   = (digits + 1) / 2;
+
+    // An odd number of digits leaves the last byte with a single one
+    if(digits % 2 != 0)
+        *out++ = hex_digits[bytes[--byte] & 0xF];
+
+    while(byte > 0)
+    {
+        std::memcpy(out, hex_table[bytes[--byte]].data(), 2);
+        out += 2;
+    }
+}
+
+bool hex_to_bits(const char* text, std::size_t count, unsigned char* bytes)
+    noexcept
+{
+    // Invalid characters map to 0xFF, so their high bits end up in invalid
+    unsigned invalid = 0;
+
+    const char* digit = text + count;
+    for(std::size_t i = 0; i < count / 2; i++)
+    {
+        digit -= 2;
+        const unsigned high = hex_values[static_cast<unsigned char>(digit[0])];
+        const unsigned low  = hex_values[static_cast<unsigned char>(digit[1])];
+        invalid |= high | low;
+        bytes[i] = static_cast<unsigned char>((high << 4) | (low & 0xF));
+    }
+
+    if(count % 2 != 0)
+    {
+        const unsigned low = hex_values[static_cast<unsigned char>(text[0])];
+        invalid |= low;
+        bytes[count / 2] = static_cast<unsigned char>(low & 0xF);
+    }
+    return (invalid & 0xF0) == 0;
+}
+
+int hex_digit_value(char c) noexcept
+{
+    const auto value = hex_values[static_cast<unsigned char>(c)];
+    return value == 0xFF ? -1 : value;
+}
+
+void write_bits_text(std::ostream&        os,
+                     const unsigned char* bytes,
+                     std::size_t          bit_count)
+{
+    constexpr std::size_t chunk_bits = 4096;
+
+    char buffer[chunk_bits];
+    for(std::size_t bit = 0; bit < bit_count; bit += chunk_bits)
+    {
+        const std::size_t length = std::min(chunk_bits, bit_count - bit);
+        bits_to_chars(bytes + bit / 8, length, buffer, '0', '1');
+        os.write(buffer, static_cast<std::streamsize>(length));
+    }
+}
+}    // namespace corgi::binary::detail
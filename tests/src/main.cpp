@@ -1,9 +1,103 @@
+#include "corgi/binary/atomic_bitset.h"
 #include "corgi/binary/binary.h"
+#include "corgi/binary/bit_expression.h"
+#include "corgi/binary/bit_layout.h"
+#include "corgi/binary/bit_reader.h"
+#include "corgi/binary/bit_span.h"
+#include "corgi/binary/bit_writer.h"
+#include "corgi/binary/bitset_io.h"
 #include "corgi/binary/dynamic_bitset.h"
+#include "corgi/binary/hierarchical_bitset.h"
+#include "corgi/binary/instrumentation.h"
+#include "corgi/binary/packed_int_vector.h"
+#include "corgi/binary/packing.h"
+#include "corgi/binary/parallel.h"
+#include "corgi/binary/rank_select.h"
+#include "corgi/binary/roaring_bitmap.h"
+#include "corgi/binary/simd.h"
 #include "corgi/test/test.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 using namespace corgi;
 
+namespace
+{
+struct packet_header
+{
+    std::uint8_t  version;
+    std::uint16_t length;
+    bool          urgent;
+    std::uint64_t payload;
+};
+
+using packet_layout =
+    binary::bit_layout<binary::bit_field<&packet_header::version, 0, 3>,
+                       binary::bit_field<&packet_header::length, 3, 12>,
+                       binary::bit_field<&packet_header::urgent, 15, 1>,
+                       binary::bit_field<&packet_header::payload, 17, 64>>;
+
+constexpr unsigned char packet[] = {0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45,
+                                    0x67, 0x89, 0x10, 0x32, 0x54};
+
+// Everything is constexpr, so the layout can be checked at compile time
+static_assert(packet_layout::byte_size == 11);
+static_assert(binary::bits_to<int, 4, 8>(std::span(packet)) == 0xDA);
+static_assert(packet_layout::decode(std::span(packet)).length ==
+              ((0xCDAB >> 3) & 0xFFF));
+
+// Fields can fill their member, whatever its signedness, but not exceed it
+enum class priority : std::int8_t
+{
+};
+static_assert(binary::detail::field_digits<priority>() == 8);
+static_assert(binary::detail::field_digits<bool>() == 1);
+static_assert(binary::detail::field_digits<std::int16_t>() == 16);
+
+template<class Left, class Right>
+concept can_and = requires(Left&& left, Right&& right) {
+    std::forward<Left>(left) & std::forward<Right>(right);
+};
+
+using lazy_bitset = binary::bitset_terminal<std::uint64_t>;
+
+// Expressions only point to bitsets that outlive them
+static_assert(can_and<lazy_bitset, const binary::dynamic_bitset&>);
+static_assert(can_and<binary::dynamic_bitset&, lazy_bitset>);
+static_assert(!can_and<lazy_bitset, binary::dynamic_bitset>);
+static_assert(!can_and<binary::dynamic_bitset&&, lazy_bitset>);
+
+/**
+ * @brief   Deterministic pseudo random numbers (64 bits LCG), so a failing
+ *          test always sees the same bits
+ */
+class random_generator
+{
+public:
+    explicit random_generator(std::uint64_t seed) noexcept
+        : state_(seed)
+    {
+    }
+
+    std::uint64_t operator()() noexcept
+    {
+        state_ = state_ * 6364136223846793005ull + 1442695040888963407ull;
+        return state_ >> 33;
+    }
+
+private:
+    std::uint64_t state_;
+};
+}    // namespace
+
 int main()
 {
     // NOTE : This test probably fails on 32 bits because I suspect this
@@ -333,5 +427,1763 @@ int main()
                        //    check_equals(subset[4], true);
                    });
 
+    test::add_test("dynamic_bitset", "multiple_blocks",
+                   []() -> void
+                   {
+                       binary::dynamic_bitset bs(130, true);
+                       check_equals(bs.all(), true);
+                       check_equals(bs.byte_size(),
+                                    static_cast<std::size_t>(17));
+                       check_equals(bs.block_size(),
+                                    static_cast<std::size_t>(3));
+
+                       bs.reset(129);
+                       check_equals(bs.all(), false);
+                       bs.pop_back();
+                       check_equals(bs.all(), true);
+
+                       bs.reset();
+                       check_equals(bs.none(), true);
+                       bs.set(128, true);
+                       check_equals(bs.any(), true);
+
+                       binary::dynamic_bitset other(129);
+                       other.set(128, true);
+                       check_equals(bs, other);
+                   });
+
+    test::add_test("dynamic_bitset", "erase_clears_tail",
+                   []() -> void
+                   {
+                       binary::dynamic_bitset bs(65, true);
+                       bs.erase(0);
+                       check_equals(bs.size(), static_cast<std::size_t>(64));
+                       check_equals(bs.all(), true);
+
+                       bs.push_back(false);
+                       check_equals(bs.test(64), false);
+                       bs.pop_back();
+                       check_equals(bs, binary::dynamic_bitset(64, true));
+                   });
+
+    test::add_test("dynamic_bitset", "flip",
+                   []() -> void
+                   {
+                       binary::dynamic_bitset bs(70);
+                       bs.flip(3);
+                       check_equals(bs.test(3), true);
+                       bs.flip();
+                       check_equals(bs.test(3), false);
+                       check_equals(bs.test(69), true);
+
+                       bs.flip(3);
+                       check_equals(bs.all(), true);
+                       check_throw(bs.flip(70), std::out_of_range);
+                   });
+
+    test::add_test("dynamic_bitset", "resize",
+                   []() -> void
+                   {
+                       binary::dynamic_bitset bs(3);
+                       bs.resize(100, true);
+                       check_equals(bs.size(), static_cast<std::size_t>(100));
+                       check_equals(bs.test(2), false);
+                       check_equals(bs.test(3), true);
+                       check_equals(bs.test(99), true);
+
+                       bs.resize(2);
+                       check_equals(bs.size(), static_cast<std::size_t>(2));
+                       bs.resize(80, false);
+                       check_equals(bs.none(), true);
+                   });
+
+    test::add_test(
+        "dynamic_bitset", "bitwise_operators",
+        []() -> void
+        {
+            const std::size_t size = 1237;
+
+            binary::dynamic_bitset a(size);
+            binary::dynamic_bitset b(size);
+            for(std::size_t i = 0; i < size; i++)
+            {
+                a.set(i, i % 3 == 0);
+                b.set(i, i % 5 < 2);
+            }
+
+            // Every kernel the CPU supports must give the same results
+            const auto levels = {binary::simd_level::scalar,
+                                 binary::simd_level::avx2,
+                                 binary::simd_level::avx512};
+            for(const auto level : levels)
+            {
+                if(level > binary::detected_simd_level())
+                    continue;
+                binary::set_simd_level(level);
+
+                const auto and_bs    = a & b;
+                const auto or_bs     = a | b;
+                const auto xor_bs    = a ^ b;
+                const auto andnot_bs = a - b;
+                const auto not_bs    = ~a;
+
+                auto in_place = a;
+                in_place &= b;
+                check_equals(in_place, and_bs);
+                in_place = a;
+                in_place |= b;
+                check_equals(in_place, or_bs);
+                in_place = a;
+                in_place ^= b;
+                check_equals(in_place, xor_bs);
+                in_place = a;
+                in_place -= b;
+                check_equals(in_place, andnot_bs);
+
+                for(std::size_t i = 0; i < size; i++)
+                {
+                    check_equals(and_bs.test(i), a.test(i) && b.test(i));
+                    check_equals(or_bs.test(i), a.test(i) || b.test(i));
+                    check_equals(xor_bs.test(i), a.test(i) != b.test(i));
+                    check_equals(andnot_bs.test(i), a.test(i) && !b.test(i));
+                    check_equals(not_bs.test(i), !a.test(i));
+                }
+
+                // Bits past the end must stay cleared
+                check_equals((~binary::dynamic_bitset(size)).all(), true);
+                check_equals((~binary::dynamic_bitset(size, true)).none(),
+                             true);
+            }
+            binary::set_simd_level(binary::detected_simd_level());
+
+            check_throw(a & binary::dynamic_bitset(3), std::invalid_argument);
+            check_throw(a |= binary::dynamic_bitset(3), std::invalid_argument);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "count",
+        []() -> void
+        {
+            binary::dynamic_bitset empty;
+            check_equals(empty.count(), static_cast<std::size_t>(0));
+
+            // Big enough to go through the Harley-Seal loop
+            const std::size_t      size = 100003;
+            binary::dynamic_bitset bs(size);
+            std::size_t            expected = 0;
+            for(std::size_t i = 0; i < size; i++)
+            {
+                if(i % 7 == 0 || i % 11 == 3)
+                {
+                    bs.set(i);
+                    expected++;
+                }
+            }
+
+            const auto levels = {binary::simd_level::scalar,
+                                 binary::simd_level::avx2,
+                                 binary::simd_level::avx512};
+            for(const auto level : levels)
+            {
+                if(level > binary::detected_simd_level())
+                    continue;
+                binary::set_simd_level(level);
+                check_equals(bs.count(), expected);
+                check_equals(binary::dynamic_bitset(size, true).count(), size);
+            }
+            binary::set_simd_level(binary::detected_simd_level());
+
+            std::size_t ranged = 0;
+            for(std::size_t i = 61; i < 70000; i++)
+                ranged += bs.test(i);
+            check_equals(bs.count(61, 70000), ranged);
+            check_equals(bs.count(0, size), expected);
+            check_equals(bs.count(7, 8), static_cast<std::size_t>(1));
+            check_equals(bs.count(5, 5), static_cast<std::size_t>(0));
+
+            check_throw(bs.count(0, size + 1), std::out_of_range);
+            check_throw(bs.count(5, 4), std::invalid_argument);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "find",
+        []() -> void
+        {
+            binary::dynamic_bitset bs(1000);
+            check_equals(bs.find_first(), binary::dynamic_bitset::npos);
+            check_equals(bs.find_last(), binary::dynamic_bitset::npos);
+
+            const std::vector<std::size_t> positions {3, 64, 65, 130, 999};
+            for(auto pos : positions)
+                bs.set(pos);
+
+            check_equals(bs.find_first(), static_cast<std::size_t>(3));
+            check_equals(bs.find_next(3), static_cast<std::size_t>(64));
+            check_equals(bs.find_next(64), static_cast<std::size_t>(65));
+            check_equals(bs.find_next(65), static_cast<std::size_t>(130));
+            check_equals(bs.find_next(131), static_cast<std::size_t>(999));
+            check_equals(bs.find_next(999), binary::dynamic_bitset::npos);
+            check_equals(bs.find_next(5000), binary::dynamic_bitset::npos);
+
+            check_equals(bs.find_last(), static_cast<std::size_t>(999));
+            check_equals(bs.find_prev(999), static_cast<std::size_t>(130));
+            check_equals(bs.find_prev(130), static_cast<std::size_t>(65));
+            check_equals(bs.find_prev(64), static_cast<std::size_t>(3));
+            check_equals(bs.find_prev(3), binary::dynamic_bitset::npos);
+            check_equals(bs.find_prev(5000), static_cast<std::size_t>(999));
+
+            std::vector<std::size_t> visited;
+            for(auto pos : bs.set_bits())
+                visited.push_back(pos);
+            check_equals(visited, positions);
+
+            const binary::dynamic_bitset full(300, true);
+            std::size_t                  count = 0;
+            for(auto pos : full.set_bits())
+                check_equals(pos, count++);
+            check_equals(count, static_cast<std::size_t>(300));
+
+            check_equals(binary::dynamic_bitset(10).set_bits().begin() ==
+                             binary::dynamic_bitset(10).set_bits().end(),
+                         true);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "insert_erase_large",
+        []() -> void
+        {
+            // Compares against std::vector<bool> for shifts that are block
+            // aligned, byte aligned and unaligned
+            std::vector<bool>      reference;
+            binary::dynamic_bitset bs;
+
+            unsigned state = 12345;
+            auto     next  = [&state]()
+            {
+                state = state * 1103515245u + 12345u;
+                return state >> 8;
+            };
+
+            for(std::size_t i = 0; i < 3000; i++)
+            {
+                const bool value = next() % 2;
+                reference.push_back(value);
+                bs.push_back(value);
+            }
+
+            const std::size_t lengths[] = {1, 3, 8, 16, 64, 77, 128, 300};
+            for(int round = 0; round < 60; round++)
+            {
+                const auto len = lengths[round % 8];
+                const auto pos = next() % (reference.size() + 1);
+
+                if(round % 2 == 0)
+                {
+                    const bool value = next() % 2;
+                    reference.insert(reference.begin() + pos, len, value);
+                    bs.insert(pos, len, value);
+                }
+                else if(pos + len <= reference.size())
+                {
+                    reference.erase(reference.begin() + pos,
+                                    reference.begin() + pos + len);
+                    bs.erase(pos, pos + len - 1);
+                }
+
+                check_equals(bs.size(), reference.size());
+            }
+
+            bs.insert(5, {true, false, true, true});
+            reference.insert(reference.begin() + 5, {true, false, true, true});
+            bs.erase(17);
+            reference.erase(reference.begin() + 17);
+
+            for(std::size_t i = 0; i < reference.size(); i++)
+                check_equals(bs.test(i), reference[i]);
+
+            std::size_t expected_count = 0;
+            for(const auto b : reference)
+                expected_count += b;
+            check_equals(bs.count(), expected_count);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "small_buffer",
+        []() -> void
+        {
+            // Starts inside the inline buffer and moves to the heap
+            binary::dynamic_bitset bs;
+            for(std::size_t i = 0; i < 300; i++)
+                bs.push_back(i % 3 == 0);
+
+            for(std::size_t i = 0; i < 300; i++)
+                check_equals(bs.test(i), i % 3 == 0);
+
+            binary::dynamic_bitset small {true, false, true};
+            auto                   copy  = small;
+            auto                   moved = std::move(copy);
+            check_equals(moved, small);
+
+            binary::dynamic_bitset big_copy = bs;
+            check_equals(big_copy, bs);
+
+            binary::dynamic_bitset big_moved = std::move(big_copy);
+            check_equals(big_moved, bs);
+
+            big_moved = small;
+            check_equals(big_moved, small);
+
+            small = std::move(bs);
+            check_equals(small.size(), static_cast<std::size_t>(300));
+            check_equals(small.count(), static_cast<std::size_t>(100));
+        });
+
+    test::add_test(
+        "dynamic_bitset", "block_types",
+        []() -> void
+        {
+            // Small blocks go through the generic kernels and straddle block
+            // boundaries much more often
+            binary::basic_dynamic_bitset<std::uint8_t> bs(37);
+            std::vector<bool>                          reference(37);
+            for(std::size_t i = 0; i < 37; i += 3)
+            {
+                bs.set(i);
+                reference[i] = true;
+            }
+
+            bs.insert(5, 19, true);
+            reference.insert(reference.begin() + 5, 19, true);
+            bs.erase(2, 11);
+            reference.erase(reference.begin() + 2, reference.begin() + 12);
+
+            check_equals(bs.size(), reference.size());
+            std::size_t expected_count = 0;
+            for(std::size_t i = 0; i < reference.size(); i++)
+            {
+                check_equals(bs.test(i), static_cast<bool>(reference[i]));
+                expected_count += reference[i];
+            }
+            check_equals(bs.count(), expected_count);
+            check_equals(bs.find_first(), static_cast<std::size_t>(0));
+            check_equals(bs.find_last(), reference.size() - 1);
+
+            const auto flipped = ~bs;
+            check_equals((bs & flipped).none(), true);
+            check_equals((bs | flipped).all(), true);
+
+            binary::basic_dynamic_bitset<std::uint32_t> word {true, false,
+                                                              true};
+            word.resize(40, false);
+            word.set(std::size_t {39});
+            check_equals(word.to_ullong(), 0x8000000005ull);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "pmr",
+        []() -> void
+        {
+            unsigned char                       buffer[1024];
+            std::pmr::monotonic_buffer_resource resource(
+                buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+            binary::pmr::dynamic_bitset bs(&resource);
+            bs.resize(1000, false);
+            bs.set(std::size_t {999});
+
+            const auto result = bs | bs;
+            check_equals(result.get_allocator().resource() == &resource, true);
+            check_equals(result.count(), static_cast<std::size_t>(1));
+
+            // Copying to the default resource leaves the buffer alone
+            binary::pmr::dynamic_bitset copy(bs, {});
+            check_equals(copy, bs);
+            check_equals(copy.get_allocator().resource() ==
+                             std::pmr::get_default_resource(),
+                         true);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "moved_from",
+        []() -> void
+        {
+            binary::dynamic_bitset bs(200, true);
+            binary::dynamic_bitset moved(std::move(bs));
+            check_equals(bs.size(), static_cast<std::size_t>(0));
+            check_equals(moved.count(), static_cast<std::size_t>(200));
+
+            // The moved from bitset can be used again
+            bs.resize(10, true);
+            check_equals(bs.count(), static_cast<std::size_t>(10));
+        });
+
+    test::add_test(
+        "dynamic_bitset", "subscript",
+        []() -> void
+        {
+            binary::dynamic_bitset bs(130);
+
+            bs[0]   = true;
+            bs[129] = true;
+            bs[64]  = bs[0];
+            bs[65].flip();
+            bs.set_unchecked(66);
+            bs.set_unchecked(0, false);
+
+            check_equals(bs.test(0), false);
+            check_equals(static_cast<bool>(bs[64]), true);
+            check_equals(~bs[65], false);
+            check_equals(bs.test_unchecked(66), true);
+            check_equals(bs.count(), static_cast<std::size_t>(4));
+
+            const auto& cbs = bs;
+            check_equals(cbs[129], true);
+            check_equals(cbs[128], false);
+
+#if defined(CORGI_BINARY_CHECKED_ACCESS)
+            check_throw(bs[130], std::out_of_range);
+            check_throw(bs.test_unchecked(130), std::out_of_range);
+#endif
+        });
+
+    test::add_test(
+        "bit_reader", "read",
+        []() -> void
+        {
+            std::vector<unsigned char> bytes(67);
+            for(std::size_t i = 0; i < bytes.size(); i++)
+                bytes[i] = static_cast<unsigned char>(i * 37 + 11);
+
+            auto expected = [&](std::size_t pos, std::size_t len)
+            {
+                std::uint64_t value = 0;
+                for(std::size_t i = 0; i < len; i++)
+                    value |= std::uint64_t((bytes[(pos + i) / 8] >>
+                                            ((pos + i) % 8)) &
+                                           1)
+                             << i;
+                return value;
+            };
+
+            // Every width, so reads land on both the fast and the tail paths
+            binary::bit_reader reader(bytes);
+            std::size_t        pos   = 0;
+            std::size_t        width = 1;
+            while(pos + width <= bytes.size() * 8)
+            {
+                check_equals(reader.peek(std::min<std::size_t>(width, 56)),
+                             expected(pos, std::min<std::size_t>(width, 56)));
+                check_equals(reader.read(width), expected(pos, width));
+                pos += width;
+                width = width % 64 + 1;
+            }
+            check_equals(reader.position(), pos);
+            check_equals(reader.remaining(), bytes.size() * 8 - pos);
+            check_throw(reader.read(bytes.size() * 8 - pos + 1),
+                        std::out_of_range);
+            check_equals(reader.position(), pos);
+        });
+
+    test::add_test(
+        "bit_reader", "skip_align",
+        []() -> void
+        {
+            const unsigned char bytes[] = {0xAB, 0xCD, 0xEF, 0x01,
+                                           0x23, 0x45, 0x67, 0x89,
+                                           0x10, 0x32};
+
+            binary::bit_reader reader(bytes);
+            check_equals(reader.read(4), std::uint64_t {0xB});
+            reader.align();
+            check_equals(reader.position(), std::size_t {8});
+            check_equals(reader.read(8), std::uint64_t {0xCD});
+            reader.align();
+            check_equals(reader.position(), std::size_t {16});
+
+            reader.skip(44);
+            check_equals(reader.read(12), std::uint64_t {0x108});
+            check_equals(reader.read(8), std::uint64_t {0x32});
+            check_equals(reader.empty(), true);
+            check_throw(reader.skip(1), std::out_of_range);
+            check_throw(reader.peek(57), std::invalid_argument);
+
+            unsigned char field[] = {0xF0, 0x0F};
+            check_equals(binary::bits_to_int(4, 8, field, 2), 0xFF);
+        });
+
+    test::add_test(
+        "bit_span", "read",
+        []() -> void
+        {
+            random_generator next(99);
+
+            binary::dynamic_bitset bits(1000, false);
+            for(std::size_t i = 0; i < bits.size(); i++)
+                bits.set(i, next() % 7 == 0);
+
+            // Every offset inside a byte, and lengths around word boundaries
+            for(const std::size_t first : {0, 1, 7, 8, 63, 64, 65, 333})
+            {
+                for(const std::size_t length : {0, 1, 63, 64, 65, 200})
+                {
+                    const auto view = bits.view().subspan(first, length);
+                    check_equals(view.size(), length);
+
+                    std::size_t count = 0;
+                    for(std::size_t i = 0; i < length; i++)
+                    {
+                        check_equals(view.test(i), bits.test(first + i));
+                        count += bits.test(first + i);
+                    }
+                    check_equals(view.count(), count);
+                    check_equals(view.count(length / 3, length),
+                                 bits.count(first + length / 3,
+                                            first + length));
+
+                    std::size_t expected = binary::const_bit_span::npos;
+                    for(std::size_t i = 0; i < length; i++)
+                    {
+                        if(bits.test(first + i))
+                        {
+                            check_equals(view.find_next(expected), i);
+                            expected = i;
+                        }
+                    }
+                    check_equals(view.find_last(), expected);
+
+                    const auto len = std::min<std::size_t>(length, 56);
+                    if(len != 0)
+                        check_equals(view.to_ullong(0, len),
+                                     bits.to_ullong(first, len));
+                }
+            }
+
+            // Same bits at different offsets compare equal
+            const auto slice = bits.slice(5, 404);
+            check_equals(slice.view() == bits.slice_view(5, 404), true);
+            check_equals(slice.view() == bits.slice_view(6, 405), false);
+            check_equals(slice, binary::dynamic_bitset(bits).slice(5, 404));
+
+            check_throw(bits.view().subspan(990, 11), std::out_of_range);
+            check_throw(bits.view().test(1000), std::out_of_range);
+            check_throw(bits.view().to_ullong(), std::overflow_error);
+            check_throw(bits.slice_view(10, 5), std::invalid_argument);
+
+            // Any buffer can be viewed, like a packet
+            const unsigned char packet[] = {0xF0, 0x0F, 0x01};
+            const binary::const_bit_span header(packet, 12, 4);
+            check_equals(header.to_ullong(), 0xFFull);
+            check_equals(header.find_first(), std::size_t {0});
+            check_equals(header.find_last(), std::size_t {7});
+            check_equals(header.all(), false);
+            check_equals(header.subspan(0, 8).all(), true);
+            check_equals(binary::const_bit_span(std::span(packet)).count(),
+                         std::size_t {9});
+        });
+
+    test::add_test(
+        "bit_span", "write",
+        []() -> void
+        {
+            unsigned char bytes[4] = {0, 0, 0, 0};
+            binary::bit_span view(bytes, 20, 6);
+
+            // Bits 6 to 25 of the bytes
+            view.set();
+            check_equals(bytes[0], static_cast<unsigned char>(0xC0));
+            check_equals(bytes[1], static_cast<unsigned char>(0xFF));
+            check_equals(bytes[2], static_cast<unsigned char>(0xFF));
+            check_equals(bytes[3], static_cast<unsigned char>(0x03));
+            check_equals(view.all(), true);
+
+            view.reset(0);
+            view.flip(19);
+            check_equals(view.count(), std::size_t {18});
+            check_equals(bytes[0], static_cast<unsigned char>(0x80));
+            check_equals(bytes[3], static_cast<unsigned char>(0x01));
+
+            view.subspan(2, 3).reset();
+            check_equals(bytes[1], static_cast<unsigned char>(0xF8));
+
+            binary::const_bit_span read_only = view;
+            check_equals(read_only == view, true);
+            check_throw(view.set(std::size_t {20}), std::out_of_range);
+
+            // A mutable slice writes to the bitset
+            binary::dynamic_bitset bits(300, false);
+            bits.slice_view(100, 199).set();
+            check_equals(bits.count(), std::size_t {100});
+            check_equals(bits.find_first(), std::size_t {100});
+            check_equals(bits.find_last(), std::size_t {199});
+        });
+
+    test::add_test(
+        "bit_writer", "round_trip",
+        []() -> void
+        {
+            // Writes fields of every width and reads them back
+            auto value_of = [](std::size_t i)
+            { return 0x9E3779B97F4A7C15ull * (i + 1); };
+
+            auto write_fields = [&](binary::bit_writer& writer)
+            {
+                for(std::size_t i = 0; i < 300; i++)
+                    writer.write(value_of(i), i % 64 + 1);
+                writer.flush();
+            };
+
+            auto check_fields = [&](std::span<const unsigned char> bytes)
+            {
+                binary::bit_reader reader(bytes);
+                for(std::size_t i = 0; i < 300; i++)
+                {
+                    const auto width = i % 64 + 1;
+                    const auto mask  = width == 64 ? ~0ull
+                                                   : (1ull << width) - 1;
+                    check_equals(reader.read(width), value_of(i) & mask);
+                }
+                check_equals(reader.remaining() < 8, true);
+            };
+
+            std::vector<unsigned char> vector {0xFF};
+            {
+                binary::bit_writer writer(vector);
+                write_fields(writer);
+                check_equals(vector.size() * 8, writer.position() + 8);
+            }
+            check_equals(vector[0], static_cast<unsigned char>(0xFF));
+            check_fields(std::span(vector).subspan(1));
+
+            std::ostringstream stream;
+            {
+                // A tiny staging buffer forces many writes to the stream
+                binary::bit_writer writer(stream, 16);
+                write_fields(writer);
+            }
+            const auto text = stream.str();
+            check_fields(std::span(
+                reinterpret_cast<const unsigned char*>(text.data()),
+                text.size()));
+            check_equals(text.size(), vector.size() - 1);
+
+            std::vector<unsigned char> storage(vector.size() - 1);
+            binary::bit_writer         writer {std::span(storage)};
+            write_fields(writer);
+            check_fields(storage);
+            check_throw(writer.write(0, 64), std::length_error);
+        });
+
+    test::add_test(
+        "bit_writer", "align",
+        []() -> void
+        {
+            std::vector<unsigned char> bytes;
+            binary::bit_writer         writer(bytes);
+            writer.write(0b101, 3);
+            writer.align();
+            writer.write_bit(true);
+            writer.write(0xABC, 12);
+            check_equals(writer.position(), std::size_t {21});
+            writer.flush();
+
+            check_equals(bytes.size(), std::size_t {3});
+            check_equals(bytes[0], static_cast<unsigned char>(0b101));
+            check_equals(bytes[1], static_cast<unsigned char>(0x79));
+            check_equals(bytes[2], static_cast<unsigned char>(0x15));
+            check_throw(writer.write(0, 65), std::invalid_argument);
+
+            // The batch overload produces the same bits as single writes
+            std::vector<std::uint64_t> values(100);
+            for(std::size_t i = 0; i < values.size(); i++)
+                values[i] = i * 0x12345;
+
+            std::vector<unsigned char> single;
+            std::vector<unsigned char> batch;
+            {
+                binary::bit_writer single_writer(single);
+                binary::bit_writer batch_writer(batch);
+                for(const auto value : values)
+                    single_writer.write(value, 23);
+                batch_writer.write(values, 23);
+                check_equals(batch_writer.position(), std::size_t {2300});
+            }
+            check_equals(single == batch, true);
+        });
+
+    test::add_test(
+        "bitset_io", "save_load",
+        []() -> void
+        {
+            // Reference values of XXH64 with seed 0
+            const unsigned char abc[] = {'a', 'b', 'c'};
+            std::vector<unsigned char> bytes(100);
+            for(std::size_t i = 0; i < bytes.size(); i++)
+                bytes[i] = static_cast<unsigned char>(i);
+
+            check_equals(binary::detail::xxhash64({}), 0xEF46DB3751D8E999ull);
+            check_equals(binary::detail::xxhash64(abc), 0x44BC2CF5AD770999ull);
+            check_equals(binary::detail::xxhash64(bytes),
+                         0x6AC1E58032166597ull);
+
+            for(const std::size_t size : {0, 1, 64, 1000, 3000000})
+            {
+                binary::dynamic_bitset bits(size, false);
+                for(std::size_t i = 0; i < size; i += 3)
+                    bits.set(i);
+
+                std::stringstream stream;
+                binary::save(bits, stream);
+
+                binary::dynamic_bitset loaded(10, true);
+                binary::load(loaded, stream);
+                check_equals(loaded, bits);
+
+                // The saved bytes can be used in place
+                const auto file = stream.str();
+                const auto view = binary::view_bitset_file(
+                    {reinterpret_cast<const unsigned char*>(file.data()),
+                     file.size()});
+                check_equals(view == bits.view(), true);
+                check_equals(file.size(),
+                             binary::bitset_file_header::size +
+                                 bits.block_size() * 8);
+            }
+
+            binary::dynamic_bitset bits(5000, false);
+            bits.set(std::size_t {4321});
+
+            std::stringstream stream;
+            binary::save(bits, stream);
+            auto file = stream.str();
+
+            const auto header = binary::read_bitset_header(
+                {reinterpret_cast<const unsigned char*>(file.data()),
+                 file.size()});
+            check_equals(header.bit_size, std::uint64_t {5000});
+            check_equals(header.payload_bytes, std::uint64_t {79 * 8});
+
+            // Corruptions are detected
+            auto load_string = [](const std::string& content)
+            {
+                std::stringstream      in(content);
+                binary::dynamic_bitset out;
+                binary::load(out, in);
+            };
+
+            auto corrupted = file;
+            corrupted[binary::bitset_file_header::size + 3] ^= 1;
+            check_throw(load_string(corrupted), std::runtime_error);
+
+            corrupted = file;
+            corrupted[0] = 'X';
+            check_throw(load_string(corrupted), std::runtime_error);
+
+            check_throw(load_string(file.substr(0, file.size() - 1)),
+                        std::ios_base::failure);
+
+            // A failed load leaves the target unchanged, even when the bits
+            // past the size are set under a matching checksum
+            binary::dynamic_bitset small(70, false);
+            small.set(std::size_t {3});
+            std::stringstream small_stream;
+            binary::save(small, small_stream);
+            auto tail_set = small_stream.str();
+            tail_set[binary::bitset_file_header::size + 8] |= 0x80;
+            const auto checksum = binary::detail::xxhash64(
+                {reinterpret_cast<const unsigned char*>(tail_set.data()) +
+                     binary::bitset_file_header::size,
+                 16});
+            std::memcpy(tail_set.data() + 32, &checksum, sizeof(checksum));
+
+            const auto check_unchanged =
+                [&small](const std::string& content, auto exception)
+            {
+                std::stringstream      in(content);
+                binary::dynamic_bitset target(small);
+                try
+                {
+                    binary::load(target, in);
+                }
+                catch(const decltype(exception)&)
+                {
+                }
+                check_equals(target, small);
+                check_equals(target.count(), std::size_t {1});
+            };
+            check_unchanged(tail_set, std::runtime_error(""));
+            check_unchanged(corrupted, std::runtime_error(""));
+            check_unchanged(file.substr(0, file.size() - 1),
+                            std::ios_base::failure(""));
+
+            // A huge size in the header doesn't allocate it upfront
+            auto huge = file;
+            const std::uint64_t huge_bits  = std::uint64_t {1} << 40;
+            const std::uint64_t huge_bytes = huge_bits / 8;
+            std::memcpy(huge.data() + 16, &huge_bits, sizeof(huge_bits));
+            std::memcpy(huge.data() + 24, &huge_bytes, sizeof(huge_bytes));
+            check_throw(load_string(huge), std::ios_base::failure);
+
+            // A size whose payload size would wrap around to 0
+            auto wrapped = file.substr(0, binary::bitset_file_header::size);
+            const std::uint64_t max_bits   = ~std::uint64_t {0};
+            const std::uint64_t no_bytes   = 0;
+            const auto          empty_hash = binary::detail::xxhash64({});
+            std::memcpy(wrapped.data() + 16, &max_bits, sizeof(max_bits));
+            std::memcpy(wrapped.data() + 24, &no_bytes, sizeof(no_bytes));
+            std::memcpy(wrapped.data() + 32, &empty_hash, sizeof(empty_hash));
+            check_throw(load_string(wrapped), std::runtime_error);
+            check_throw(binary::view_bitset_file(
+                            {reinterpret_cast<const unsigned char*>(
+                                 wrapped.data()),
+                             wrapped.size()}),
+                        std::runtime_error);
+
+            // File descriptors
+            auto* tmp = std::tmpfile();
+            check_equals(tmp != nullptr, true);
+            if(tmp == nullptr)
+                return;
+
+            binary::save(bits, fileno(tmp));
+            std::rewind(tmp);
+
+            binary::dynamic_bitset from_fd;
+            binary::load(from_fd, fileno(tmp));
+            check_equals(from_fd, bits);
+            check_throw(binary::load(from_fd, fileno(tmp)),
+                        std::runtime_error);
+            check_equals(from_fd, bits);
+            std::fclose(tmp);
+
+            // The size of the file is checked before allocating
+            auto* huge_tmp = std::tmpfile();
+            check_equals(huge_tmp != nullptr, true);
+            if(huge_tmp == nullptr)
+                return;
+
+            std::fwrite(huge.data(), 1, huge.size(), huge_tmp);
+            std::fflush(huge_tmp);
+            std::rewind(huge_tmp);
+            check_throw(binary::load(from_fd, fileno(huge_tmp)),
+                        std::runtime_error);
+            check_equals(from_fd, bits);
+            std::fclose(huge_tmp);
+        });
+
+    test::add_test(
+        "corgi-binary", "bits_to",
+        []() -> void
+        {
+            unsigned char bytes[sizeof(packet)];
+            std::copy(std::begin(packet), std::end(packet), bytes);
+
+            const auto wide   = binary::bits_to<long long, 5, 27>(bytes);
+            const auto single = binary::bits_to<int, 9, 1>(bytes);
+            const auto full   = binary::bits_to<std::uint64_t, 3, 64>(bytes);
+            check_equals(wide,
+                         binary::bits_to_llong(5, 27, bytes, sizeof(bytes)));
+            check_equals(single,
+                         binary::bits_to_int(9, 1, bytes, sizeof(bytes)));
+            check_equals(full, 0x112CE8A4603DF9B5ull);
+
+            const auto header = packet_layout::decode(bytes);
+            check_equals(header.version, std::uint8_t {0x3});
+            check_equals(header.length, std::uint16_t {0x9B5});
+            check_equals(header.urgent, true);
+            const auto payload = binary::bits_to<std::uint64_t, 17, 64>(bytes);
+            check_equals(header.payload, payload);
+        });
+
+    test::add_test(
+        "packing", "pack_unpack",
+        []() -> void
+        {
+            const auto levels = {binary::simd_level::scalar,
+                                 binary::simd_level::avx2};
+
+            for(const auto level : levels)
+            {
+                if(level > binary::detected_simd_level())
+                    continue;
+                binary::set_simd_level(level);
+
+                for(std::size_t width = 0; width <= 32; width++)
+                {
+                    for(const std::size_t count : {1, 7, 8, 9, 31, 200})
+                    {
+                        for(std::size_t offset = 0; offset < 10; offset += 3)
+                        {
+                            std::vector<std::uint32_t> values(count);
+                            for(std::size_t i = 0; i < count; i++)
+                                values[i] = static_cast<std::uint32_t>(
+                                    (i + 1) * 0x9E3779B9u + width);
+
+                            // Sized exactly, so any overread is caught by
+                            // the sanitizers
+                            std::vector<unsigned char> bytes(
+                                (offset + width * count + 7) / 8 + 1, 0xFF);
+                            binary::pack(bytes.data(), offset, width, count,
+                                         values.data());
+
+                            std::vector<std::uint32_t> unpacked(count);
+                            binary::unpack(bytes.data(), offset, width, count,
+                                           unpacked.data());
+
+                            binary::bit_reader reader(bytes);
+                            check_equals(reader.read(offset),
+                                         (std::uint64_t {1} << offset) - 1);
+
+                            const auto mask =
+                                width == 32 ? 0xFFFFFFFFu
+                                            : (1u << width) - 1;
+                            for(std::size_t i = 0; i < count; i++)
+                            {
+                                check_equals(unpacked[i], values[i] & mask);
+                                check_equals(reader.read(width),
+                                             std::uint64_t {values[i] & mask});
+                            }
+
+                            // Bits after the packed range are left untouched
+                            while(!reader.empty())
+                                check_equals(reader.read(1), std::uint64_t {1});
+                        }
+                    }
+                }
+            }
+            binary::set_simd_level(binary::detected_simd_level());
+
+            std::uint32_t value = 0;
+            check_throw(binary::unpack(nullptr, 0, 33, 1, &value),
+                        std::invalid_argument);
+        });
+
+    test::add_test(
+        "packed_int_vector", "static_width",
+        []() -> void
+        {
+            binary::packed_int_vector<17> vector;
+            std::vector<std::uint64_t>    reference;
+
+            for(std::uint64_t i = 0; i < 300; i++)
+            {
+                vector.push_back(i * 0x9E3779B9u);
+                reference.push_back((i * 0x9E3779B9u) & 0x1FFFF);
+            }
+
+            check_equals(vector.size(), reference.size());
+            check_equals(vector.byte_size(), std::size_t {(300 * 17 + 7) / 8});
+            for(std::size_t i = 0; i < reference.size(); i++)
+                check_equals(vector[i], reference[i]);
+
+            vector.set(5, 0x1FFFF);
+            vector.set(3, 0);
+            reference[5] = 0x1FFFF;
+            reference[3] = 0;
+            check_equals(vector.get(5), reference[5]);
+            check_equals(vector.get(4), reference[4]);
+            check_equals(vector.get(6), reference[6]);
+            check_equals(vector.get(3), std::uint64_t {0});
+
+            check_equals(std::equal(vector.begin(), vector.end(),
+                                    reference.begin(), reference.end()),
+                         true);
+            check_equals(vector.end() - vector.begin(), 300);
+
+            vector.resize(10);
+            check_equals(vector.back(), reference[9]);
+
+            // Growing again gives zeros, not the dropped integers
+            vector.resize(20);
+            check_equals(vector.get(15), std::uint64_t {0});
+
+            vector.pop_back();
+            check_equals(vector.size(), std::size_t {19});
+
+            check_throw(vector.get(19), std::out_of_range);
+            check_throw(vector.set(19, 1), std::out_of_range);
+
+            binary::packed_int_vector<17> list {1, 2, 3};
+            binary::packed_int_vector<17> copy = list;
+            check_equals(list == copy, true);
+            copy.set(2, 4);
+            check_equals(list == copy, false);
+        });
+
+    test::add_test(
+        "packed_int_vector", "dynamic_width",
+        []() -> void
+        {
+            for(std::size_t width = 1; width <= 64; width++)
+            {
+                binary::packed_int_vector<> vector(width);
+                check_equals(vector.width(), width);
+
+                const auto mask = vector.max_value();
+                std::vector<std::uint64_t> reference;
+                for(std::uint64_t i = 0; i < 100; i++)
+                {
+                    const auto value = i * 0x9E3779B97F4A7C15ull + width;
+                    vector.push_back(value);
+                    reference.push_back(value & mask);
+                }
+
+                // Overwriting an integer leaves its neighbours untouched
+                for(std::size_t i = 0; i < reference.size(); i += 7)
+                {
+                    vector.set(i, ~reference[i]);
+                    reference[i] = ~reference[i] & mask;
+                }
+
+                for(std::size_t i = 0; i < reference.size(); i++)
+                    check_equals(vector.get(i), reference[i]);
+
+                std::vector<std::uint64_t> copied(reference.size());
+                vector.copy_to(0, copied.size(), copied.data());
+                check_equals(copied == reference, true);
+            }
+
+            check_throw(binary::packed_int_vector<>(0), std::invalid_argument);
+            check_throw(binary::packed_int_vector<>(65),
+                        std::invalid_argument);
+        });
+
+    test::add_test(
+        "packed_int_vector", "bulk",
+        []() -> void
+        {
+            for(const std::size_t width : {5, 23, 32, 40})
+            {
+                binary::packed_int_vector<> vector(width);
+                vector.push_back(1);
+
+                std::vector<std::uint32_t> values(1000);
+                for(std::size_t i = 0; i < values.size(); i++)
+                    values[i] = static_cast<std::uint32_t>(i * 0x9E3779B9u);
+                vector.append(values);
+                check_equals(vector.size(), std::size_t {1001});
+
+                const auto mask = vector.max_value();
+                for(std::size_t i = 0; i < values.size(); i++)
+                    check_equals(vector.get(i + 1), values[i] & mask);
+
+                if(width <= 32)
+                {
+                    std::vector<std::uint32_t> out(values.size());
+                    vector.copy_to(1, out.size(), out.data());
+                    for(std::size_t i = 0; i < values.size(); i++)
+                        check_equals(std::uint64_t {out[i]}, values[i] & mask);
+                }
+                else
+                {
+                    std::uint32_t out = 0;
+                    check_throw(vector.copy_to(0, 1, &out),
+                                std::invalid_argument);
+                }
+
+                std::uint64_t out = 0;
+                check_throw(vector.copy_to(1000, 2, &out), std::out_of_range);
+            }
+        });
+
+    test::add_test(
+        "rank_select", "rank_select",
+        []() -> void
+        {
+            auto check_index = [](const binary::dynamic_bitset& bits,
+                                  const binary::rank_select&    index)
+            {
+                std::size_t rank = 0;
+                for(std::size_t i = 0; i < bits.size(); i++)
+                {
+                    check_equals(index.rank(i), rank);
+                    if(bits.test(i))
+                    {
+                        check_equals(index.select(rank), i);
+                        rank++;
+                    }
+                }
+                check_equals(index.rank(bits.size()), rank);
+                check_equals(index.count(), rank);
+                check_equals(index.select(rank), binary::rank_select::npos);
+            };
+
+            random_generator next(12345);
+
+            // Dense and sparse bitsets, with sizes around superblock ends
+            for(const std::size_t size : {0, 1, 63, 64, 511, 512, 513, 40000})
+            {
+                for(const std::uint64_t density : {2, 50})
+                {
+                    binary::dynamic_bitset bits(size, false);
+                    for(std::size_t i = 0; i < size; i++)
+                        bits.set(i, next() % density == 0);
+
+                    binary::rank_select index(bits);
+                    check_index(bits, index);
+                }
+            }
+
+            // A full bitset goes through several select samples
+            binary::dynamic_bitset full(3 * binary::rank_select::select_sample +
+                                            100,
+                                        true);
+            binary::rank_select    full_index(full);
+            check_equals(full_index.select(20000), std::size_t {20000});
+            check_equals(full_index.rank(full.size() - 1), full.size() - 1);
+
+            check_equals(full_index.memory_usage() * 8 <= full.size() / 3,
+                         true);
+            check_throw(full_index.rank(full.size() + 1), std::out_of_range);
+
+            // Incremental updates
+            binary::dynamic_bitset bits(5000, false);
+            binary::rank_select    index(bits);
+            for(std::size_t i = 0; i < 200; i++)
+            {
+                const auto pos = static_cast<std::size_t>(next() % bits.size());
+                bits.set(pos, !bits.test(pos));
+                index.update(bits, pos, pos + 1);
+            }
+            check_index(bits, index);
+
+            for(std::size_t i = 0; i < 700; i++)
+                bits.push_back(i % 3 == 0);
+            index.update(bits, 5000, bits.size());
+            check_index(bits, index);
+
+            bits.resize(1000);
+            index.update(bits, 1000, 1000);
+            check_index(bits, index);
+        });
+
+    test::add_test(
+        "roaring_bitmap", "add_remove",
+        []() -> void
+        {
+            binary::roaring_bitmap bitmap {70000, 3, 1ull << 40, 3};
+
+            check_equals(bitmap.count(), std::size_t {3});
+            check_equals(bitmap.contains(3), true);
+            check_equals(bitmap.contains(4), false);
+            check_equals(bitmap.find_first(), std::size_t {3});
+            check_equals(bitmap.find_last(), std::size_t {1ull << 40});
+
+            std::vector<std::size_t> positions(bitmap.begin(), bitmap.end());
+            check_equals(positions, (std::vector<std::size_t> {
+                                        3, 70000, std::size_t {1ull << 40}}));
+
+            // Crosses the array / bitmap threshold both ways
+            for(std::size_t i = 0; i < 10000; i++)
+                bitmap.add(2 * i);
+            check_equals(bitmap.count(), std::size_t {10003});
+            for(std::size_t i = 0; i < 10000; i++)
+                bitmap.remove(2 * i);
+            check_equals(bitmap.count(), std::size_t {3});
+            check_equals(bitmap.contains(3), true);
+
+            // Ranges are stored as runs, which split and merge
+            bitmap.add_range(100, 200000);
+            check_equals(bitmap.count(), std::size_t {199900 + 2});
+            bitmap.remove(1000);
+            check_equals(bitmap.contains(1000), false);
+            check_equals(bitmap.contains(1001), true);
+            bitmap.add(1000);
+            check_equals(bitmap.count(), std::size_t {199902});
+            check_equals(bitmap.memory_usage() < 1000, true);
+
+            bitmap.remove(3);
+            bitmap.remove(1ull << 40);
+            check_equals(bitmap.find_first(), std::size_t {100});
+            check_equals(bitmap.find_last(), std::size_t {199999});
+            check_throw(bitmap.add_range(2, 1), std::invalid_argument);
+
+            bitmap.clear();
+            check_equals(bitmap.empty(), true);
+            check_equals(bitmap.begin() == bitmap.end(), true);
+            check_equals(bitmap.find_first(), binary::roaring_bitmap::npos);
+        });
+
+    test::add_test(
+        "roaring_bitmap", "set_operations",
+        []() -> void
+        {
+            random_generator next(777);
+
+            // Sparse, dense and run chunks, so every pair of containers meets
+            constexpr std::size_t size = 6 * 65536;
+            auto make = [&next](std::size_t offset)
+            {
+                binary::dynamic_bitset bits(size, false);
+                for(std::size_t i = 0; i < 65536; i++)
+                {
+                    bits.set(i, next() % 100 == 0);
+                    bits.set(65536 + i, next() % 3 == 0);
+                    bits.set(2 * 65536 + i, (i + offset) % 5000 < 2000);
+                    bits.set(3 * 65536 + i, next() % 50 == 0);
+                }
+                for(std::size_t i = 0; i < 65536; i += 1 + offset)
+                    bits.set(4 * 65536 + i);
+                return bits;
+            };
+
+            const auto a_bits = make(0);
+            const auto b_bits = make(1000);
+
+            const binary::roaring_bitmap a(a_bits);
+            const binary::roaring_bitmap b(b_bits);
+
+            check_equals(a.count(), a_bits.count());
+            check_equals(a.to_bitset(size), a_bits);
+            check_equals(a.to_bitset().size(), a_bits.find_last() + 1);
+            check_throw(a.to_bitset(100), std::out_of_range);
+
+            // Iteration matches the set bits of the bitset
+            std::vector<std::size_t> expected;
+            for(auto pos : a_bits.set_bits())
+                expected.push_back(pos);
+            check_equals(std::vector<std::size_t>(a.begin(), a.end()),
+                         expected);
+
+            check_equals((a & b).to_bitset(size), a_bits & b_bits);
+            check_equals((a | b).to_bitset(size), a_bits | b_bits);
+            check_equals((a ^ b).to_bitset(size), a_bits ^ b_bits);
+            check_equals((a - b).to_bitset(size), a_bits - b_bits);
+            check_equals((b - a).to_bitset(size), b_bits - a_bits);
+            check_equals((a ^ a).empty(), true);
+
+            // Same results with the containers stored as runs
+            auto runs = a;
+            runs.run_optimize();
+            check_equals(runs == a, true);
+            check_equals((runs & b) == (a & b), true);
+            check_equals((runs | b) == (a | b), true);
+            check_equals((b - runs) == (b - a), true);
+
+            // A run of 2 bits takes as much memory as an array, which wins
+            // the tie, so the array only becomes a run once it grows
+            // npos is the end of the iterators, so it can't be a position
+            binary::roaring_bitmap last;
+            last.add(5);
+            check_throw(last.add(binary::roaring_bitmap::npos),
+                        std::out_of_range);
+            last.add_range(binary::roaring_bitmap::npos - 2,
+                           binary::roaring_bitmap::npos);
+            check_equals(last.count(), std::size_t {3});
+            check_equals(static_cast<std::size_t>(
+                             std::distance(last.begin(), last.end())),
+                         std::size_t {3});
+            check_equals(last.find_last(), binary::roaring_bitmap::npos - 1);
+
+            binary::roaring_bitmap tie;
+            tie.add_range(0, 2);
+            tie.add(2);
+            check_equals(tie.run_optimize(), true);
+
+            auto c = a;
+            c |= b;
+            c -= a;
+            check_equals(c == (b - a), true);
+            check_equals(c == a, false);
+
+            // A sparse bitmap takes a fraction of the dense bitset
+            binary::dynamic_bitset sparse(10000000, false);
+            for(std::size_t i = 0; i < sparse.size(); i += 10007)
+                sparse.set(i);
+            const binary::roaring_bitmap compressed(sparse);
+            check_equals(compressed.memory_usage() * 10 < sparse.byte_size(),
+                         true);
+            check_equals(compressed.to_bitset(sparse.size()), sparse);
+        });
+
+    test::add_test(
+        "atomic_bitset", "single_thread",
+        []() -> void
+        {
+            binary::atomic_bitset bits(130);
+            check_equals(bits.size(), std::size_t {130});
+            check_equals(bits.count(), std::size_t {0});
+
+            check_equals(bits.test_and_set(129), false);
+            check_equals(bits.test_and_set(129), true);
+            check_equals(bits.test(129), true);
+            check_equals(bits.fetch_flip(3, std::memory_order_relaxed), false);
+            check_equals(bits.fetch_reset(3), true);
+            check_equals(bits.fetch_reset(3), false);
+            bits.set(64);
+            check_equals(bits.count(), std::size_t {2});
+
+            binary::dynamic_bitset other(130, false);
+            other.set(std::size_t {0});
+            other.set(std::size_t {64});
+            bits.merge(other);
+            check_equals(bits.count(), std::size_t {3});
+
+            auto copy = bits.to_bitset();
+            check_equals(copy.find_first(), std::size_t {0});
+            check_equals(copy.find_last(), std::size_t {129});
+            check_equals(binary::atomic_bitset(copy).count(), copy.count());
+
+            binary::atomic_bitset moved(std::move(bits));
+            check_equals(moved.count(), std::size_t {3});
+            check_equals(bits.size(), std::size_t {0});
+
+            moved.clear();
+            check_equals(moved.count(), std::size_t {0});
+
+            check_throw(moved.test(130), std::out_of_range);
+            check_throw(moved.merge(binary::dynamic_bitset(10)),
+                        std::invalid_argument);
+        });
+
+    test::add_test(
+        "atomic_bitset", "stress",
+        []() -> void
+        {
+            // Every thread marks the same bits in a different order, each bit
+            // must be claimed exactly once
+            constexpr std::size_t size    = 100000;
+            constexpr std::size_t threads = 8;
+
+            binary::atomic_bitset    visited(size);
+            binary::atomic_bitset    merged(size);
+            std::vector<std::size_t> claimed(threads, 0);
+            std::vector<std::thread> workers;
+
+            for(std::size_t t = 0; t < threads; t++)
+            {
+                workers.emplace_back(
+                    [&, t]()
+                    {
+                        binary::dynamic_bitset local(size, false);
+                        for(std::size_t i = 0; i < size; i++)
+                        {
+                            const auto pos = (i * 7919 + t * 104729) % size;
+                            if(!visited.test_and_set(pos))
+                            {
+                                claimed[t]++;
+                                local.set(pos);
+                            }
+                        }
+                        merged.merge(local, std::memory_order_relaxed);
+                    });
+            }
+
+            for(auto& worker : workers)
+                worker.join();
+
+            std::size_t total = 0;
+            for(const auto count : claimed)
+                total += count;
+
+            check_equals(total, size);
+            check_equals(visited.count(), size);
+            check_equals(merged.count(), size);
+        });
+
+    test::add_test(
+        "parallel", "bulk_operations",
+        []() -> void
+        {
+            // A threshold of 0 splits even small bitsets between the threads
+            const binary::parallel_policy policy {.thread_count     = 5,
+                                                  .serial_threshold = 0};
+
+            // The ranges start on the cache lines of the address, even when
+            // the array doesn't start on one
+            alignas(64) std::uint64_t storage[200];
+            std::vector<std::pair<std::size_t, std::size_t>> ranges;
+            std::mutex                                       ranges_mutex;
+            binary::detail::parallel_for(
+                policy, storage + 3, 190,
+                [&](std::size_t first, std::size_t last)
+                {
+                    std::lock_guard lock(ranges_mutex);
+                    ranges.emplace_back(first, last);
+                });
+            std::sort(ranges.begin(), ranges.end());
+            check_equals(ranges.size(), std::size_t {5});
+            check_equals(ranges.front().first, std::size_t {0});
+            check_equals(ranges.back().second, std::size_t {190});
+            for(std::size_t i = 1; i < ranges.size(); i++)
+            {
+                check_equals(ranges[i].first, ranges[i - 1].second);
+                check_equals(reinterpret_cast<std::uintptr_t>(
+                                 storage + 3 + ranges[i].first) %
+                                 64,
+                             std::uintptr_t {0});
+            }
+
+            // Not a multiple of a cache line, nor of a block
+            const std::size_t size = 64 * 8 * 13 + 37;
+
+            binary::dynamic_bitset a(size, false);
+            binary::dynamic_bitset b(size, false);
+            for(std::size_t i = 0; i < size; i += 3)
+                a.set(i);
+            for(std::size_t i = 0; i < size; i += 5)
+                b.set(i);
+
+            check_equals(binary::count(policy, a), a.count());
+            check_equals(binary::any(policy, a), true);
+            check_equals(binary::all(policy, a), false);
+            check_equals(binary::equal(policy, a, a), true);
+            check_equals(binary::equal(policy, a, b), false);
+
+            auto expected = a;
+            auto result   = a;
+            expected &= b;
+            binary::and_assign(policy, result, b);
+            check_equals(result == expected, true);
+
+            expected = a;
+            result   = a;
+            expected |= b;
+            binary::or_assign(policy, result, b);
+            check_equals(result == expected, true);
+
+            expected = a;
+            result   = a;
+            expected ^= b;
+            binary::xor_assign(policy, result, b);
+            check_equals(result == expected, true);
+
+            expected = a;
+            result   = a;
+            expected.flip();
+            binary::flip(policy, result);
+            check_equals(result == expected, true);
+
+            binary::set(policy, result);
+            check_equals(binary::all(policy, result), true);
+            check_equals(binary::count(policy, result), size);
+
+            // Only the last bit is missing, inside the partial block
+            result.reset(size - 1);
+            check_equals(binary::all(policy, result), false);
+
+            binary::reset(policy, result);
+            check_equals(binary::none(policy, result), true);
+            result.set(size - 1);
+            check_equals(binary::any(policy, result), true);
+
+            binary::dynamic_bitset other_size(size + 1, false);
+            check_equals(binary::equal(policy, a, other_size), false);
+            check_throw(binary::and_assign(policy, a, other_size),
+                        std::invalid_argument);
+
+            // The default threshold keeps small bitsets on the calling thread
+            check_equals(binary::count(binary::parallel, a), a.count());
+        });
+
+    test::add_test(
+        "hierarchical_bitset", "find",
+        []() -> void
+        {
+            // 3 levels, the last word of each being partially used
+            const std::size_t size = 64 * 64 * 3 + 100;
+
+            binary::hierarchical_bitset bits(size);
+            check_equals(bits.level_count(), std::size_t {3});
+            check_equals(bits.none(), true);
+            check_equals(bits.find_first(), binary::hierarchical_bitset::npos);
+            check_equals(bits.find_last(), binary::hierarchical_bitset::npos);
+
+            const std::vector<std::size_t> positions {0,    63,   64,
+                                                      4095, 4096, 9000,
+                                                      size - 1};
+            for(const auto pos : positions)
+                bits.set(pos);
+
+            check_equals(bits.any(), true);
+            check_equals(bits.count(), positions.size());
+            check_equals(bits.find_first(), std::size_t {0});
+            check_equals(bits.find_last(), size - 1);
+
+            // Walks every set bit both ways
+            std::size_t index = 0;
+            for(auto pos = bits.find_first();
+                pos != binary::hierarchical_bitset::npos;
+                pos = bits.find_next(pos))
+                check_equals(pos, positions[index++]);
+            check_equals(index, positions.size());
+
+            for(auto pos = bits.find_last();
+                pos != binary::hierarchical_bitset::npos;
+                pos = bits.find_prev(pos))
+                check_equals(pos, positions[--index]);
+            check_equals(index, std::size_t {0});
+
+            check_equals(bits.find_next(4096), std::size_t {9000});
+            check_equals(bits.find_prev(4095), std::size_t {64});
+            check_equals(bits.find_prev(size + 10), size - 1);
+
+            // Emptying a word clears its summary bits
+            bits.reset(4096);
+            check_equals(bits.level(1)[1], std::uint64_t {0});
+            check_equals(bits.find_next(4095), std::size_t {9000});
+
+            for(const auto pos : positions)
+                bits.set(pos, false);
+            check_equals(bits.none(), true);
+            check_equals(bits.level(2)[0], std::uint64_t {0});
+
+            check_throw(bits.set(size), std::out_of_range);
+            check_throw(bits.test(size), std::out_of_range);
+
+            // Matches dynamic_bitset on random bits
+            binary::dynamic_bitset reference(size, false);
+            for(std::size_t i = 0; i < size; i += 97 + i % 13)
+                reference.set(i);
+
+            const binary::hierarchical_bitset copy(reference);
+            check_equals(copy.to_bitset() == reference, true);
+            for(std::size_t pos = 0; pos < size; pos += 31)
+            {
+                check_equals(copy.find_next(pos), reference.find_next(pos));
+                check_equals(copy.find_prev(pos), reference.find_prev(pos));
+            }
+
+            binary::hierarchical_bitset built(size);
+            for(auto pos = reference.find_first();
+                pos != binary::dynamic_bitset::npos;
+                pos = reference.find_next(pos))
+                built.set(pos);
+            check_equals(built == copy, true);
+
+            built.clear();
+            check_equals(built.any(), false);
+
+            const binary::hierarchical_bitset empty;
+            check_equals(empty.any(), false);
+            check_equals(empty.find_first(), binary::hierarchical_bitset::npos);
+        });
+
+    test::add_test(
+        "dynamic_bitset", "find_first_run",
+        []() -> void
+        {
+            const auto npos = binary::dynamic_bitset::npos;
+
+            // Compares against a bit by bit search on a pattern with runs of
+            // every length, crossing block boundaries
+            binary::dynamic_bitset bits(1000, false);
+            for(std::size_t i = 0, run = 1; i < bits.size(); run++)
+            {
+                bits.set_range(i, std::min(i + run, bits.size()));
+                i += 2 * run;
+            }
+
+            auto naive = [&](bool value, std::size_t length, std::size_t from)
+            {
+                std::size_t run = 0;
+                for(auto i = from; i < bits.size(); i++)
+                {
+                    run = bits.test(i) == value ? run + 1 : 0;
+                    if(run == length)
+                        return i + 1 - length;
+                }
+                return npos;
+            };
+
+            for(const bool value : {true, false})
+                for(std::size_t length = 1; length < 100; length += 7)
+                    for(std::size_t from = 0; from < bits.size(); from += 61)
+                        check_equals(bits.find_first_run(value, length, from),
+                                     naive(value, length, from));
+
+            check_equals(bits.find_first_run(true, 0, 10), std::size_t {10});
+            check_equals(bits.find_first_run(true, 0, 1001), npos);
+            check_equals(bits.find_first_run(true, 2000), npos);
+
+            // The bits past size() don't count as unset
+            binary::dynamic_bitset tail(70, true);
+            tail.reset_range(66, 70);
+            check_equals(tail.find_first_run(false, 4), std::size_t {66});
+            check_equals(tail.find_first_run(false, 5), npos);
+
+            // 16M pages of 4 KiB, 64 GiB, mostly allocated
+            binary::dynamic_bitset pages(std::size_t {1} << 24, true);
+            pages.reset_range(1000, 1003);
+            pages.reset_range(9'000'000, 9'000'300);
+
+            check_equals(pages.claim_run(3), std::size_t {1000});
+            check_equals(pages.claim_run(4), std::size_t {9'000'000});
+            check_equals(pages.claim_run(256), std::size_t {9'000'004});
+            check_equals(pages.find_first_run(false, 1),
+                         std::size_t {9'000'260});
+            check_equals(pages.count(), pages.size() - 40);
+            check_equals(pages.claim_run(41), npos);
+
+            pages.reset_range(9'000'000, 9'000'260);
+            check_equals(pages.claim_run(300), std::size_t {9'000'000});
+
+            check_throw(pages.set_range(10, pages.size() + 1),
+                        std::out_of_range);
+            check_throw(pages.set_range(10, 5), std::invalid_argument);
+
+            // Other block types take the same path
+            binary::basic_dynamic_bitset<std::uint8_t> small(100, false);
+            small.set_range(3, 40);
+            check_equals(small.find_first_run(true, 37), std::size_t {3});
+            check_equals(small.find_first_run(true, 38), npos);
+            check_equals(small.find_first_run(false, 60), std::size_t {40});
+        });
+
+    test::add_test(
+        "instrumentation", "counters",
+        []() -> void
+        {
+            binary::reset_instrumentation();
+
+            binary::dynamic_bitset bits(64, false);
+            for(std::size_t i = 0; i < 1000; i++)
+                bits.push_back(i % 2 == 0);
+
+            bits.set(std::size_t {3});
+            const auto value = bits.test(3);
+            bits.flip();
+            const auto part = bits.slice(10, 99);
+            check_throw(bits.test(bits.size()), std::out_of_range);
+
+            const auto counters = binary::read_instrumentation();
+
+            if constexpr(!binary::instrumentation_enabled)
+            {
+                // The hooks are compiled out
+                check_equals(counters.reallocations, std::uint64_t {0});
+                check_equals(counters.bit_operations, std::uint64_t {0});
+                check_equals(counters.exceptions, std::uint64_t {0});
+                return;
+            }
+
+            // The inline buffer, then geometric growth
+            check_equals(counters.reallocations > 0, true);
+            check_equals(counters.reallocations < 20, true);
+            check_equals(counters.bytes_allocated >= bits.block_size() * 8,
+                         true);
+            check_equals(counters.slices, std::uint64_t {1});
+            check_equals(counters.bytes_copied >= part.size() / 8, true);
+
+            // 1000 push_back, set() and test()
+            check_equals(counters.bit_operations, std::uint64_t {1002});
+            check_equals(counters.word_operations,
+                         std::uint64_t {bits.block_size()});
+            check_equals(counters.exceptions, std::uint64_t {1});
+            check_equals(value, true);
+
+            // Threads that exited still count
+            std::thread([] { binary::dynamic_bitset(10, false).test(1); })
+                .join();
+            check_equals(binary::read_instrumentation().bit_operations,
+                         std::uint64_t {1003});
+
+            binary::reset_instrumentation();
+            check_equals(binary::read_instrumentation().bit_operations,
+                         std::uint64_t {0});
+        });
+
+    test::add_test(
+        "dynamic_bitset", "text",
+        []() -> void
+        {
+            using namespace corgi;
+
+            binary::dynamic_bitset bits(203, false);
+            for(std::size_t i = 0; i < bits.size(); i += 3)
+                bits.set(i);
+            bits.set(std::size_t {202});
+
+            std::string expected;
+            for(std::size_t i = 0; i < bits.size(); i++)
+                expected += bits.test(i) ? '1' : '0';
+
+            check_equals(binary::to_string(bits), expected);
+            check_equals(binary::from_string(expected) == bits, true);
+
+            std::ostringstream stream;
+            stream << bits;
+            check_equals(stream.str(), expected);
+
+            check_equals(binary::to_string(bits, '.', '#').substr(0, 7),
+                         std::string("#..#..#"));
+            check_equals(binary::from_string(binary::to_string(bits, '.', '#'),
+                                             '.',
+                                             '#') == bits,
+                         true);
+
+            // Bit 0 is the lowest bit of the last digit
+            const auto small = binary::from_string("1000110001");
+            check_equals(binary::to_hex_string(small), std::string("231"));
+            check_equals(binary::from_hex_string("231", 10) == small, true);
+            check_equals(binary::from_hex_string("0231", 10) == small, true);
+            check_equals(binary::from_hex_string("ABC").size(),
+                         std::size_t {12});
+            check_equals(binary::from_hex_string(binary::to_hex_string(bits),
+                                                 bits.size()) == bits,
+                         true);
+
+            check_throw(binary::from_string("0102"), std::invalid_argument);
+            check_throw(binary::from_string("0101010101010101x"),
+                        std::invalid_argument);
+            check_throw(binary::from_hex_string("12g"),
+                        std::invalid_argument);
+            check_throw(binary::from_hex_string("631", 10),
+                        std::invalid_argument);
+            check_throw(binary::from_hex_string("1231", 10),
+                        std::invalid_argument);
+        });
+
+    test::add_test(
+        "bit_expression", "fused",
+        []() -> void
+        {
+            using namespace corgi;
+            using binary::lazy;
+
+            // Several chunks, and a last block partially used
+            const std::size_t      size = 70000;
+            binary::dynamic_bitset a(size, false);
+            binary::dynamic_bitset b(size, false);
+            binary::dynamic_bitset c(size, false);
+            binary::dynamic_bitset d(size, false);
+            for(std::size_t i = 0; i < size; i++)
+            {
+                a.set(i, i % 2 == 0);
+                b.set(i, i % 3 == 0);
+                c.set(i, i % 5 == 0);
+                d.set(i, i % 7 == 0);
+            }
+
+            const auto eager = (a & b) | (c & ~d);
+
+            const binary::dynamic_bitset fused =
+                (lazy(a) & b) | (lazy(c) & ~lazy(d));
+            check_equals(fused == eager, true);
+            check_equals(((lazy(a) & b) | (lazy(c) & ~lazy(d))).count(),
+                         eager.count());
+
+            check_equals((lazy(a) ^ b).count(), (a ^ b).count());
+            check_equals((lazy(a) - b).count(), (a - b).count());
+
+            // ~ doesn't count the bits past size()
+            check_equals((~lazy(a)).count(), size - a.count());
+            check_equals((~lazy(a) | a).all(), true);
+
+            check_equals((lazy(b) & c).any(), true);
+            check_equals((lazy(a) & ~lazy(a)).any(), false);
+            check_equals((lazy(a) & ~lazy(a)).none(), true);
+
+            // The result can overwrite an operand
+            auto target = a;
+            assign(target, lazy(b) | (lazy(target) & c));
+            check_equals(target == (b | (a & c)), true);
+
+            assign(target, lazy(d));
+            check_equals(target == d, true);
+
+            binary::dynamic_bitset other(10, false);
+            check_throw(lazy(a) & other, std::invalid_argument);
+        });
+
     return test::run_all();
 }
\ No newline at end of file